@@ -0,0 +1,3 @@
+set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
+try_compile(FELSPAR_HAS_PPOLL ${PROJECT_BINARY_DIR}
+    ${CMAKE_CURRENT_SOURCE_DIR}/cmake/ppoll.cpp)
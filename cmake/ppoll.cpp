@@ -0,0 +1,6 @@
+#include <poll.h>
+
+
+int detect_ppoll(::pollfd *fds, ::nfds_t nfds, ::timespec const *timeout) {
+    return ::ppoll(fds, nfds, timeout, nullptr);
+}
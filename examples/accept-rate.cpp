@@ -0,0 +1,121 @@
+#include <felspar/io.hpp>
+
+#include <iomanip>
+#include <iostream>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    /**
+     * ## Accept rate
+     *
+     * A number of clients connect to a listening socket as fast as they can
+     * while a single accept stream takes the connections and closes them.
+     * The clients reset their connections when closing them so that the
+     * benchmark doesn't run out of ephemeral ports.
+     */
+    felspar::io::warden::task<void> acceptor(
+            felspar::io::warden &ward,
+            felspar::posix::fd const &listener,
+            std::size_t const count) {
+        std::size_t accepted{};
+        for (auto connections = felspar::io::accept(ward, listener);
+             auto cnx = co_await connections.next();) {
+            felspar::posix::fd{*cnx};
+            if (++accepted == count) { co_return; }
+        }
+    }
+
+
+    felspar::io::warden::task<void> client(
+            felspar::io::warden &ward,
+            std::uint16_t const port,
+            std::size_t const count) {
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        for (std::size_t index{}; index < count; ++index) {
+            auto fd = ward.create_tcp_socket();
+            ::linger const reset{1, 0};
+            ::setsockopt(
+                    fd.native_handle(), SOL_SOCKET, SO_LINGER, &reset,
+                    sizeof(reset));
+            co_await ward.connect(
+                    fd, reinterpret_cast<sockaddr const *>(&in), sizeof(in));
+        }
+    }
+
+
+    felspar::io::warden::task<double> accepts_per_second(
+            felspar::io::warden &ward,
+            std::uint16_t const port,
+            std::size_t const clients,
+            std::size_t const count) {
+        auto listener = ward.create_tcp_socket();
+        felspar::posix::set_reuse_port(listener);
+        felspar::posix::bind_to_any_address(listener, port);
+        felspar::posix::listen(listener, 1024);
+
+        auto const started = std::chrono::steady_clock::now();
+        felspar::io::warden::eager<> accepting;
+        accepting.post(acceptor, std::ref(ward), std::cref(listener), count);
+        /// The last client also makes any connections left over
+        std::vector<felspar::io::warden::eager<>> connecting(clients);
+        for (std::size_t index{}; index < clients; ++index) {
+            auto const share = count / clients
+                    + (index + 1 == clients ? count % clients : 0);
+            connecting[index].post(client, std::ref(ward), port, share);
+        }
+        for (auto &c : connecting) { co_await std::move(c).release(); }
+        co_await std::move(accepting).release();
+        std::chrono::duration<double> const taken =
+                std::chrono::steady_clock::now() - started;
+
+        co_return double(count) / taken.count();
+    }
+
+
+    template<typename Warden>
+    void measure(
+            std::string_view const name,
+            std::uint16_t const port,
+            std::size_t const count) {
+        for (std::size_t const clients : {1, 8, 64}) {
+            Warden ward;
+            auto const rate =
+                    ward.run(accepts_per_second, port, clients, count);
+            std::cout << std::setw(8) << name << std::setw(10) << clients
+                      << std::setw(14) << std::fixed << std::setprecision(0)
+                      << rate << '\n';
+        }
+    }
+
+
+}
+
+
+int main() {
+    try {
+        constexpr std::size_t count{20'000};
+        std::cout << "Accepted connections per second over " << count
+                  << " connections\n"
+                  << std::setw(8) << "warden" << std::setw(10) << "clients"
+                  << std::setw(14) << "accepts/s" << '\n';
+        measure<felspar::io::poll_warden>("poll", 4060, count);
+#ifdef FELSPAR_ENABLE_EPOLL
+        measure<felspar::io::epoll_warden>("epoll", 4061, count);
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+        measure<felspar::io::uring_warden>("uring", 4062, count);
+#endif
+        return 0;
+    } catch (std::exception const &e) {
+        std::cerr << "Caught an exception: " << e.what() << '\n';
+        return -1;
+    }
+}
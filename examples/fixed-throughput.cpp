@@ -0,0 +1,123 @@
+#include <felspar/io.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    /**
+     * ## Fixed buffer throughput
+     *
+     * Bulk data is sent over a loopback TCP connection in large chunks, once
+     * using `read_some`/`write_some` and once with buffers that have been
+     * registered with the warden and `read_fixed`/`write_fixed`.
+     */
+    constexpr std::size_t total_bytes{1 << 30};
+
+
+    felspar::io::warden::task<void> sender(
+            felspar::io::warden &ward,
+            felspar::posix::fd const &fd,
+            felspar::io::registered_buffer const chunk,
+            bool const fixed) {
+        for (std::size_t sent{}; sent < total_bytes;) {
+            auto const left = std::min(chunk.size(), total_bytes - sent);
+            auto const part = chunk.first(left);
+            sent += fixed ? co_await ward.write_fixed(fd, part)
+                          : co_await ward.write_some(fd, part.data());
+        }
+    }
+
+
+    felspar::io::warden::task<void> receiver(
+            felspar::io::warden &ward,
+            felspar::posix::fd const &fd,
+            felspar::io::registered_buffer const chunk,
+            bool const fixed) {
+        for (std::size_t received{}; received < total_bytes;) {
+            auto const bytes = fixed ? co_await ward.read_fixed(fd, chunk)
+                                     : co_await ward.read_some(fd, chunk.data());
+            if (not bytes) { co_return; }
+            received += bytes;
+        }
+    }
+
+
+    felspar::io::warden::task<double> megabytes_per_second(
+            felspar::io::warden &ward,
+            std::uint16_t const port,
+            std::size_t const chunk_size,
+            bool const fixed) {
+        auto listener = ward.create_tcp_socket();
+        felspar::posix::set_reuse_port(listener);
+        felspar::posix::bind_to_any_address(listener, port);
+        felspar::posix::listen(listener, 1);
+
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        auto client = ward.create_tcp_socket();
+        co_await ward.connect(
+                client, reinterpret_cast<sockaddr const *>(&in), sizeof(in));
+        felspar::posix::fd server{co_await ward.accept(listener)};
+
+        std::vector<std::byte> out(chunk_size), back(chunk_size);
+        std::array<std::span<std::byte>, 2> memory{out, back};
+        auto const chunks = ward.register_buffers(memory);
+
+        auto const started = std::chrono::steady_clock::now();
+        felspar::io::warden::eager<> sending;
+        sending.post(
+                sender, std::ref(ward), std::cref(client), chunks[0], fixed);
+        co_await receiver(ward, server, chunks[1], fixed);
+        co_await std::move(sending).release();
+        std::chrono::duration<double> const taken =
+                std::chrono::steady_clock::now() - started;
+        ward.unregister_buffers();
+
+        co_return double(total_bytes) / (1 << 20) / taken.count();
+    }
+
+
+    template<typename Warden>
+    void measure(std::string_view const name, std::uint16_t const port) {
+        for (std::size_t const chunk : {64u << 10, 256u << 10, 1u << 20}) {
+            Warden ward;
+            auto const plain =
+                    ward.run(megabytes_per_second, port, chunk, false);
+            auto const fixed = ward.run(megabytes_per_second, port, chunk, true);
+            std::cout << std::setw(8) << name << std::setw(10)
+                      << (chunk >> 10) << "KB" << std::setw(12) << std::fixed
+                      << std::setprecision(0) << plain << std::setw(12)
+                      << fixed << '\n';
+        }
+    }
+
+
+}
+
+
+int main() {
+    try {
+        std::cout << "MB/s sending " << (total_bytes >> 20)
+                  << "MB over loopback TCP\n"
+                  << std::setw(8) << "warden" << std::setw(12) << "chunk"
+                  << std::setw(12) << "some" << std::setw(12) << "fixed"
+                  << '\n';
+        measure<felspar::io::poll_warden>("poll", 4070);
+#ifdef FELSPAR_ENABLE_IO_URING
+        measure<felspar::io::uring_warden>("uring", 4071);
+#endif
+        return 0;
+    } catch (std::exception const &e) {
+        std::cerr << "Caught an exception: " << e.what() << '\n';
+        return -1;
+    }
+}
@@ -0,0 +1,96 @@
+#include <felspar/io.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    /**
+     * ## Cross-thread hand off latency
+     *
+     * Two wardens are run on their own threads and a coroutine is moved back
+     * and forth between them using `resume_on`. The time for each round trip
+     * is recorded, which is two hand offs, each of which has to wake a
+     * waiting loop.
+     */
+    constexpr std::size_t round_trips{100000};
+
+
+    felspar::io::warden::task<void> idle(
+            felspar::io::warden &ward, std::atomic<bool> const &finished) {
+        while (not finished) { co_await ward.sleep(10ms); }
+    }
+
+
+    felspar::io::warden::task<std::vector<std::chrono::nanoseconds>>
+            ping_pong(felspar::io::warden &home, felspar::io::warden &away) {
+        std::vector<std::chrono::nanoseconds> times;
+        times.reserve(round_trips);
+        for (std::size_t index{}; index < round_trips; ++index) {
+            auto const started = std::chrono::steady_clock::now();
+            co_await felspar::io::resume_on{away};
+            co_await felspar::io::resume_on{home};
+            times.push_back(std::chrono::steady_clock::now() - started);
+        }
+        co_return times;
+    }
+    /// The loop only looks at this coroutine, which never leaves its thread
+    felspar::io::warden::task<std::vector<std::chrono::nanoseconds>>
+            measure_on(felspar::io::warden &home, felspar::io::warden &away) {
+        co_return co_await ping_pong(home, away);
+    }
+
+
+    template<typename Warden>
+    void measure(std::string_view const name) {
+        Warden home, away;
+        std::atomic<bool> finished{false};
+        std::thread remote{[&]() { away.run(idle, std::cref(finished)); }};
+        auto times = home.run(measure_on, std::ref(away));
+        finished = true;
+        remote.join();
+
+        std::sort(times.begin(), times.end());
+        auto const at = [&](double const p) {
+            return std::chrono::duration<double, std::micro>(
+                           times[std::size_t(p * (times.size() - 1))])
+                    .count();
+        };
+        std::cout << std::setw(8) << name << std::fixed << std::setprecision(1)
+                  << std::setw(10) << at(0.5) << std::setw(10) << at(0.99)
+                  << std::setw(10) << at(0.999) << '\n';
+    }
+
+
+}
+
+
+int main() {
+    try {
+        std::cout << "Round trip times in µs for " << round_trips
+                  << " pairs of hand offs\n"
+                  << std::setw(8) << "warden" << std::setw(10) << "p50"
+                  << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+                  << '\n';
+        measure<felspar::io::poll_warden>("poll");
+#ifdef FELSPAR_ENABLE_EPOLL
+        measure<felspar::io::epoll_warden>("epoll");
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+        measure<felspar::io::uring_warden>("uring");
+#endif
+        return 0;
+    } catch (std::exception const &e) {
+        std::cerr << "Caught an exception: " << e.what() << '\n';
+        return -1;
+    }
+}
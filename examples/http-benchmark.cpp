@@ -11,28 +11,47 @@ namespace {
     /// ## HTTP response options
     std::span<std::byte const> short_text();
     std::span<std::byte const> big_octets();
+    constexpr std::size_t zero_copy_size{8 << 10};
 
 
     /**
      * ## HTTP requests
      *
-     * Processes HTTP requests on the connection.
+     * Processes HTTP requests on the connection. The request is read through
+     * the warden's buffer pool so that a connection waiting for its request
+     * doesn't hold a read buffer. The request ends at the first empty line.
      */
     felspar::io::warden::task<void> http_request(
             felspar::io::warden &ward,
             felspar::posix::fd fd,
             std::span<std::byte const> const response) {
-        felspar::io::read_buffer<std::array<char, 2 << 10>> buffer;
-        [[maybe_unused]] auto const request{
-                co_await felspar::io::read_until_lf_strip_cr(ward, fd, buffer)};
-        for (auto header = co_await felspar::io::read_until_lf_strip_cr(
-                     ward, fd, buffer);
-             header.size();
-             header = co_await felspar::io::read_until_lf_strip_cr(
-                     ward, fd, buffer)) {
-            // TODO The headers should really be processed
+        bool line_empty = false, complete = false;
+        while (not complete) {
+            auto const read = co_await ward.read_pooled(fd);
+            if (read.empty()) { co_return; }
+            for (auto const b : read.data()) {
+                // TODO The request and headers should really be processed
+                if (b == std::byte{'\n'} and line_empty) {
+                    complete = true;
+                    break;
+                } else if (b == std::byte{'\n'}) {
+                    line_empty = true;
+                } else if (b != std::byte{'\r'}) {
+                    line_empty = false;
+                }
+            }
+        }
+        if (response.size() >= zero_copy_size) {
+            /// Large responses are shared by all connections, so are never
+            /// copied into the socket buffers
+            for (auto out = response; out.size();) {
+                auto const sent = co_await ward.send_zc(fd, out);
+                if (not sent) { co_return; }
+                out = out.subspan(sent);
+            }
+        } else {
+            co_await write_all(ward, fd, response);
         }
-        co_await write_all(ward, fd, response);
         co_await ward.close(std::move(fd));
         co_return;
     }
@@ -40,7 +59,7 @@ namespace {
     /**
      * ## Accept loop
      *
-     * There will be one of these per thread.
+     * There is one of these per thread, each with its own listening socket.
      */
     felspar::io::warden::task<void> accept_loop(
             felspar::io::warden &ward, const felspar::posix::fd &socket) {
@@ -54,22 +73,10 @@ namespace {
     }
 
 
-    /// ## Main
-    felspar::io::warden::task<int> co_main(felspar::io::warden &ward) {
-        constexpr std::uint16_t port{4040};
-        constexpr int backlog = 64;
-
-        /// Create the accept socket
-        auto fd = ward.create_socket(AF_INET, SOCK_STREAM, 0);
-        felspar::posix::set_reuse_port(fd);
-        felspar::posix::bind_to_any_address(fd, port);
-        felspar::posix::listen(fd, backlog);
-
-        /// Run the web server forever
-        co_await ::accept_loop(ward, fd);
-
-        co_return 0;
-    }
+    /// ## One warden per core
+    using pool_type = felspar::io::warden_pool<felspar::io::poll_warden>;
+    constexpr std::uint16_t port{4040};
+    constexpr int backlog = 64;
 
 
 }
@@ -79,8 +86,12 @@ int main() {
     try {
         std::cout << "Starting web server for current directory\n";
         felspar::posix::promise_to_never_use_select();
-        felspar::io::poll_warden ward{};
-        return ward.run(co_main);
+        pool_type pool{pool_type::cores(), felspar::io::frame_pool::options{}};
+        pool.listen(port, backlog);
+        std::cout << "Running " << pool.size() << " wardens\n";
+        /// Run the web server forever
+        pool.run(accept_loop);
+        return 0;
     } catch (std::exception const &e) {
         std::cerr << "Caught an exception: " << e.what() << '\n';
         return -1;
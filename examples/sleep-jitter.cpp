@@ -0,0 +1,95 @@
+#include <felspar/io.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    /**
+     * ## Sleep jitter
+     *
+     * Repeatedly sleeps for the requested duration and records how late each
+     * wake up is. The time between consecutive wake ups is used so that the
+     * measurement starts from about the same point the warden does.
+     *
+     * The `poll` and `epoll` wardens measure sleeps from the time the loop
+     * last read its clock, which is a little before the coroutine reads the
+     * clock. If the thread is pre-empted between the two a wake up can
+     * appear to be early by that much.
+     */
+    felspar::io::warden::task<std::vector<std::chrono::nanoseconds>> sleeps(
+            felspar::io::warden &ward,
+            std::chrono::nanoseconds const duration,
+            std::size_t const count) {
+        std::vector<std::chrono::nanoseconds> lateness;
+        lateness.reserve(count);
+        auto last = std::chrono::steady_clock::now();
+        for (std::size_t index{}; index < count; ++index) {
+            co_await ward.sleep(duration);
+            auto const now = std::chrono::steady_clock::now();
+            lateness.push_back(now - last - duration);
+            last = now;
+        }
+        co_return lateness;
+    }
+
+
+    void report(
+            std::string_view const name,
+            std::chrono::nanoseconds const duration,
+            std::vector<std::chrono::nanoseconds> lateness) {
+        std::sort(lateness.begin(), lateness.end());
+        auto const at = [&](double const percentile) {
+            auto const index = static_cast<std::size_t>(
+                    percentile * double(lateness.size() - 1));
+            return std::chrono::duration<double, std::micro>{lateness[index]}
+                    .count();
+        };
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << name
+                  << std::setw(10)
+                  << std::chrono::duration<double, std::micro>{duration}.count()
+                  << std::setw(10) << at(0) << std::setw(10) << at(0.5)
+                  << std::setw(10) << at(0.99) << std::setw(10) << at(1)
+                  << '\n';
+    }
+
+
+    template<typename Warden>
+    void measure(std::string_view const name, std::size_t const count) {
+        for (auto const duration : {100us, 250us, 1000us, 2500us}) {
+            Warden ward;
+            report(name, duration, ward.run(sleeps, duration, count));
+        }
+    }
+
+
+}
+
+
+int main() {
+    try {
+        constexpr std::size_t count{500};
+        std::cout << "Lateness of sleeps in microseconds over " << count
+                  << " sleeps (negative is early)\n"
+                  << std::setw(8) << "warden" << std::setw(10) << "sleep"
+                  << std::setw(10) << "min" << std::setw(10) << "median"
+                  << std::setw(10) << "p99" << std::setw(10) << "max" << '\n';
+        measure<felspar::io::poll_warden>("poll", count);
+#ifdef FELSPAR_ENABLE_EPOLL
+        measure<felspar::io::epoll_warden>("epoll", count);
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+        measure<felspar::io::uring_warden>("uring", count);
+#endif
+        return 0;
+    } catch (std::exception const &e) {
+        std::cerr << "Caught an exception: " << e.what() << '\n';
+        return -1;
+    }
+}
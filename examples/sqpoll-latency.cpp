@@ -0,0 +1,110 @@
+#include <felspar/io.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    /**
+     * ## Submission queue polling latency
+     *
+     * A single byte is bounced back and forth over a loopback TCP connection
+     * and the round trip times are recorded. This is run with normal
+     * submission and then with a kernel thread polling the submission queue,
+     * optionally pinned to the CPU given on the command line.
+     */
+    constexpr std::size_t round_trips{100000};
+
+
+    felspar::io::warden::task<void>
+            bounce(felspar::io::warden &ward, felspar::posix::fd const &fd) {
+        std::array<std::byte, 1> buffer;
+        while (co_await ward.read_some(fd, buffer)) {
+            co_await ward.write_some(fd, buffer);
+        }
+    }
+
+
+    felspar::io::warden::task<std::vector<std::chrono::nanoseconds>>
+            round_trip(felspar::io::warden &ward, std::uint16_t const port) {
+        auto listener = ward.create_tcp_socket();
+        felspar::posix::set_reuse_port(listener);
+        felspar::posix::bind_to_any_address(listener, port);
+        felspar::posix::listen(listener, 1);
+
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        auto client = ward.create_tcp_socket();
+        co_await ward.connect(
+                client, reinterpret_cast<sockaddr const *>(&in), sizeof(in));
+        felspar::posix::fd server{co_await ward.accept(listener)};
+
+        felspar::io::warden::eager<> bouncing;
+        bouncing.post(bounce, std::ref(ward), std::cref(server));
+
+        std::vector<std::chrono::nanoseconds> times;
+        times.reserve(round_trips);
+        std::array<std::byte, 1> buffer{std::byte{1}};
+        for (std::size_t index{}; index < round_trips; ++index) {
+            auto const started = std::chrono::steady_clock::now();
+            co_await ward.write_some(client, buffer);
+            co_await ward.read_some(client, buffer);
+            times.push_back(std::chrono::steady_clock::now() - started);
+        }
+        client.close();
+        co_await std::move(bouncing).release();
+        co_return times;
+    }
+
+
+    void measure(
+            std::string_view const name,
+            felspar::io::uring_warden::options const &o,
+            std::uint16_t const port) {
+        felspar::io::uring_warden ward{o};
+        auto times = ward.run(round_trip, port);
+        std::sort(times.begin(), times.end());
+        auto const at = [&](double const p) {
+            return std::chrono::duration<double, std::micro>(
+                           times[std::size_t(p * (times.size() - 1))])
+                    .count();
+        };
+        std::cout << std::setw(8) << name << std::fixed << std::setprecision(1)
+                  << std::setw(10) << at(0.5) << std::setw(10) << at(0.99)
+                  << std::setw(10) << at(0.999) << std::setw(12)
+                  << ward.ring_statistics().kernel_enters << std::setw(10)
+                  << ward.ring_statistics().sq_wakeups << '\n';
+    }
+
+
+}
+
+
+int main(int const argc, char const *const argv[]) {
+    try {
+        felspar::io::uring_warden::sq_poll polling;
+        if (argc > 1) { polling.cpu = std::stoul(argv[1]); }
+
+        std::cout << "Round trip times in µs for " << round_trips
+                  << " single byte exchanges\n"
+                  << std::setw(8) << "ring" << std::setw(10) << "p50"
+                  << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+                  << std::setw(12) << "enters" << std::setw(10) << "wakeups"
+                  << '\n';
+        measure("normal", {}, 4090);
+        measure("sqpoll", {.polling = polling}, 4091);
+        return 0;
+    } catch (std::exception const &e) {
+        std::cerr << "Caught an exception: " << e.what() << '\n';
+        return -1;
+    }
+}
@@ -0,0 +1,151 @@
+#include <felspar/io.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    /**
+     * ## System calls per request
+     *
+     * A number of clients make requests over loopback TCP connections to a
+     * server running on the same uring warden. Each request is either a
+     * small echo or a minimal HTTP request, and the number of times the
+     * warden entered the kernel is reported per request. This is run with
+     * the default ring set up and again with the task running and ring file
+     * descriptor options turned on.
+     */
+    struct protocol {
+        std::string_view name, request, response;
+    };
+    constexpr protocol echo{"echo", "0123456789abcdef", "0123456789abcdef"};
+    constexpr protocol http{
+            "http", "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n",
+            "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nOK"};
+
+    constexpr std::size_t clients{32}, requests{2000};
+
+
+    felspar::io::warden::task<void> serve(
+            felspar::io::warden &ward,
+            felspar::posix::fd fd,
+            protocol const &p) {
+        std::array<std::byte, 256> buffer;
+        std::size_t pending{};
+        while (auto const bytes = co_await ward.read_some(fd, buffer)) {
+            /// Requests are fixed size, so may be counted off by length
+            pending += bytes;
+            for (; pending >= p.request.size(); pending -= p.request.size()) {
+                co_await felspar::io::write_all(ward, fd, p.response);
+            }
+        }
+    }
+
+
+    felspar::io::warden::task<void> server(
+            felspar::io::warden &ward,
+            felspar::posix::fd const &listener,
+            protocol const &p) {
+        std::vector<felspar::io::warden::eager<>> connections(clients);
+        for (auto &c : connections) {
+            c.post(serve, std::ref(ward),
+                   felspar::posix::fd{co_await ward.accept(listener)},
+                   std::cref(p));
+        }
+        for (auto &c : connections) { co_await std::move(c).release(); }
+    }
+
+
+    felspar::io::warden::task<void> client(
+            felspar::io::warden &ward,
+            std::uint16_t const port,
+            protocol const &p) {
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        auto fd = ward.create_tcp_socket();
+        co_await ward.connect(
+                fd, reinterpret_cast<sockaddr const *>(&in), sizeof(in));
+
+        std::array<std::byte, 256> buffer;
+        for (std::size_t index{}; index < requests; ++index) {
+            co_await felspar::io::write_all(ward, fd, p.request);
+            for (std::size_t received{}; received < p.response.size();) {
+                auto const bytes = co_await ward.read_some(fd, buffer);
+                if (not bytes) { co_return; }
+                received += bytes;
+            }
+        }
+    }
+
+
+    felspar::io::warden::task<void> exchange(
+            felspar::io::warden &ward,
+            std::uint16_t const port,
+            protocol const &p) {
+        auto listener = ward.create_tcp_socket();
+        felspar::posix::set_reuse_port(listener);
+        felspar::posix::bind_to_any_address(listener, port);
+        felspar::posix::listen(listener, clients);
+
+        felspar::io::warden::eager<> serving;
+        serving.post(server, std::ref(ward), std::cref(listener), std::cref(p));
+        std::vector<felspar::io::warden::eager<>> connecting(clients);
+        for (auto &c : connecting) {
+            c.post(client, std::ref(ward), port, std::cref(p));
+        }
+        for (auto &c : connecting) { co_await std::move(c).release(); }
+        co_await std::move(serving).release();
+    }
+
+
+    void measure(
+            std::string_view const name,
+            felspar::io::uring_warden::options const &o,
+            std::uint16_t const port) {
+        for (auto const *p : {&echo, &http}) {
+            felspar::io::uring_warden ward{o};
+            auto const started = std::chrono::steady_clock::now();
+            ward.run(exchange, port, *p);
+            std::chrono::duration<double> const taken =
+                    std::chrono::steady_clock::now() - started;
+            double const total = clients * requests;
+            std::cout << std::setw(8) << name << std::setw(8) << p->name
+                      << std::setw(12) << std::fixed << std::setprecision(3)
+                      << ward.ring_statistics().kernel_enters / total
+                      << std::setw(12) << std::setprecision(0)
+                      << total / taken.count() << '\n';
+        }
+    }
+
+
+}
+
+
+int main() {
+    try {
+        std::cout << clients << " clients making " << requests
+                  << " requests each over loopback TCP\n"
+                  << std::setw(8) << "ring" << std::setw(8) << "request"
+                  << std::setw(12) << "enters/req" << std::setw(12) << "req/s"
+                  << '\n';
+        measure("default", {}, 4080);
+        measure("tuned",
+                {.single_issuer = true,
+                 .defer_taskrun = true,
+                 .coop_taskrun = true,
+                 .register_ring_fd = true},
+                4081);
+        return 0;
+    } catch (std::exception const &e) {
+        std::cerr << "Caught an exception: " << e.what() << '\n';
+        return -1;
+    }
+}
@@ -0,0 +1,112 @@
+#include <felspar/io.hpp>
+#include <felspar/coro/starter.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    /**
+     * ## Uneven load
+     *
+     * Requests arrive at a warden once a millisecond. Most of them need a
+     * few microseconds of CPU time, but every tenth needs several
+     * milliseconds, and every hundredth starts a burst of them. The time from
+     * each request's arrival to its completion is recorded, first with all
+     * of the work done on the warden's thread and then with the heavy work
+     * moved onto a work stealing pool.
+     */
+    constexpr std::size_t requests{3000};
+    constexpr auto spacing = 1ms;
+    constexpr std::chrono::microseconds light{20}, heavy{4000};
+
+    using clock = std::chrono::steady_clock;
+
+
+    void busy_for(std::chrono::nanoseconds const duration) {
+        auto const until = clock::now() + duration;
+        while (clock::now() < until) {}
+    }
+
+
+    felspar::io::warden::task<void> handle(
+            felspar::io::warden &ward,
+            felspar::io::work_pool *const pool,
+            std::chrono::nanoseconds const cost,
+            clock::time_point const arrived,
+            std::vector<std::chrono::nanoseconds> &times) {
+        if (pool and cost > light) {
+            co_await felspar::io::run_on_pool(
+                    ward, *pool, [cost]() { busy_for(cost); });
+        } else {
+            busy_for(cost);
+        }
+        times.push_back(clock::now() - arrived);
+    }
+
+
+    felspar::io::warden::task<std::vector<std::chrono::nanoseconds>>
+            generate(felspar::io::warden &ward, felspar::io::work_pool *pool) {
+        std::vector<std::chrono::nanoseconds> times;
+        times.reserve(requests);
+        felspar::io::warden::starter<void> handlers;
+        auto const start = clock::now();
+        for (std::size_t index{}; index < requests; ++index) {
+            auto const arrival = start + index * spacing;
+            if (auto const now = clock::now(); arrival > now) {
+                co_await ward.sleep(arrival - now);
+            }
+            auto const cost =
+                    (index % 10 == 0 or index % 100 < 5) ? heavy : light;
+            handlers.post(
+                    handle, std::ref(ward), pool, cost, arrival,
+                    std::ref(times));
+            handlers.garbage_collect_completed();
+        }
+        co_await handlers.wait_for_all();
+        co_return times;
+    }
+
+
+    void measure(std::string_view const name, felspar::io::work_pool *pool) {
+        felspar::io::poll_warden ward;
+        auto times = ward.run(generate, pool);
+        std::sort(times.begin(), times.end());
+        auto const at = [&](double const p) {
+            return std::chrono::duration<double, std::milli>(
+                           times[std::size_t(p * (times.size() - 1))])
+                    .count();
+        };
+        std::cout << std::setw(8) << name << std::fixed << std::setprecision(2)
+                  << std::setw(10) << at(0.5) << std::setw(10) << at(0.99)
+                  << std::setw(10) << at(0.999) << std::setw(10)
+                  << (pool ? pool->steals() : 0) << '\n';
+    }
+
+
+}
+
+
+int main() {
+    try {
+        std::cout << "Request latency in ms for " << requests
+                  << " requests\n"
+                  << std::setw(8) << "work" << std::setw(10) << "p50"
+                  << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+                  << std::setw(10) << "steals" << '\n';
+        measure("inline", nullptr);
+        felspar::io::work_pool pool;
+        measure("pool", &pool);
+        return 0;
+    } catch (std::exception const &e) {
+        std::cerr << "Caught an exception: " << e.what() << '\n';
+        return -1;
+    }
+}
@@ -3,14 +3,21 @@
 
 #include <felspar/io/accept.hpp>
 #include <felspar/io/allocator.hpp>
+#include <felspar/io/buffered.writer.hpp>
 #include <felspar/io/connect.hpp>
 #include <felspar/io/error.hpp>
 #include <felspar/io/exceptions.hpp>
 #include <felspar/io/pipe.hpp>
 #include <felspar/io/posix.hpp>
 #include <felspar/io/read.hpp>
+#include <felspar/io/resolver.hpp>
+#ifdef FELSPAR_ENABLE_EPOLL
+#include <felspar/io/warden.epoll.hpp>
+#endif
 #include <felspar/io/warden.poll.hpp>
+#include <felspar/io/warden.pool.hpp>
 #ifdef FELSPAR_ENABLE_IO_URING
 #include <felspar/io/warden.uring.hpp>
 #endif
+#include <felspar/io/work.pool.hpp>
 #include <felspar/io/write.hpp>
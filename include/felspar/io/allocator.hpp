@@ -48,10 +48,20 @@ namespace felspar::io {
                 felspar::source_location const &loc) override {
             return backing_warden.do_close(fd, loc);
         }
+        void do_cancel_all(
+                socket_descriptor const fd,
+                felspar::source_location const &loc) override {
+            backing_warden.do_cancel_all(fd, loc);
+        }
+        void do_post(std::function<void()> f) override {
+            backing_warden.do_post(std::move(f));
+        }
+        void do_wake() noexcept override { backing_warden.do_wake(); }
         iop<void> do_sleep(
                 std::chrono::nanoseconds const time,
+                std::chrono::nanoseconds const slack,
                 felspar::source_location const &loc) override {
-            return backing_warden.do_sleep(time, loc);
+            return backing_warden.do_sleep(time, slack, loc);
         }
         iop<std::size_t> do_read_some(
                 socket_descriptor const fd,
@@ -67,6 +77,98 @@ namespace felspar::io {
                 felspar::source_location const &loc) override {
             return backing_warden.do_write_some(fd, buffer, timeout, loc);
         }
+        iop<std::size_t> do_read_some_v(
+                socket_descriptor const fd,
+                std::span<std::span<std::byte> const> const buffers,
+                std::optional<std::chrono::nanoseconds> const timeout,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_read_some_v(fd, buffers, timeout, loc);
+        }
+        iop<std::size_t> do_write_some_v(
+                socket_descriptor const fd,
+                std::span<std::span<std::byte const> const> const buffers,
+                std::optional<std::chrono::nanoseconds> const timeout,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_write_some_v(fd, buffers, timeout, loc);
+        }
+        iop<std::size_t> do_send_zc(
+                socket_descriptor const fd,
+                std::span<std::byte const> const buffer,
+                std::optional<std::chrono::nanoseconds> const timeout,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_send_zc(fd, buffer, timeout, loc);
+        }
+        iop<std::size_t> do_send_file_some(
+                socket_descriptor const sock,
+                socket_descriptor const file,
+                std::uint64_t const offset,
+                std::size_t const length,
+                std::optional<std::chrono::nanoseconds> const timeout,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_send_file_some(
+                    sock, file, offset, length, timeout, loc);
+        }
+        iop<std::size_t> do_read_at(
+                socket_descriptor const fd,
+                std::span<std::byte> const buffer,
+                std::uint64_t const offset,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_read_at(fd, buffer, offset, loc);
+        }
+        iop<std::size_t> do_write_at(
+                socket_descriptor const fd,
+                std::span<std::byte const> const buffer,
+                std::uint64_t const offset,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_write_at(fd, buffer, offset, loc);
+        }
+        iop<socket_descriptor> do_open(
+                char const *const path,
+                int const flags,
+                int const mode,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_open(path, flags, mode, loc);
+        }
+        iop<void> do_fsync(
+                socket_descriptor const fd,
+                bool const data_only,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_fsync(fd, data_only, loc);
+        }
+        iop<file_status> do_stat(
+                socket_descriptor const fd,
+                char const *const path,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_stat(fd, path, loc);
+        }
+        std::vector<registered_buffer> do_register_buffers(
+                std::span<std::span<std::byte> const> const buffers,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_register_buffers(buffers, loc);
+        }
+        void do_unregister_buffers() override {
+            backing_warden.do_unregister_buffers();
+        }
+        iop<std::size_t> do_read_fixed(
+                socket_descriptor const fd,
+                registered_buffer const &b,
+                std::optional<std::chrono::nanoseconds> const timeout,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_read_fixed(fd, b, timeout, loc);
+        }
+        iop<std::size_t> do_write_fixed(
+                socket_descriptor const fd,
+                registered_buffer const &b,
+                std::optional<std::chrono::nanoseconds> const timeout,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_write_fixed(fd, b, timeout, loc);
+        }
+        iop<buffer_lease> do_read_pooled(
+                socket_descriptor const fd,
+                std::optional<std::chrono::nanoseconds> const timeout,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_read_pooled(fd, timeout, loc);
+        }
         void do_prepare_socket(
                 socket_descriptor const sock,
                 felspar::source_location const &loc) override {
@@ -86,6 +188,11 @@ namespace felspar::io {
                 felspar::source_location const &loc) override {
             return backing_warden.do_connect(fd, addr, len, timeout, loc);
         }
+        stream<socket_descriptor> do_accept_stream(
+                socket_descriptor const fd,
+                felspar::source_location const &loc) override {
+            return backing_warden.do_accept_stream(fd, loc);
+        }
         iop<void> do_read_ready(
                 socket_descriptor const fd,
                 std::optional<std::chrono::nanoseconds> const timeout,
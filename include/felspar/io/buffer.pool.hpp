@@ -0,0 +1,145 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+
+namespace felspar::io {
+
+
+    class buffer_pool;
+
+
+    /// ## Buffer lease
+    /**
+     * The bytes read by a pooled read. The buffer they were read into goes
+     * back to its pool when the lease is destroyed or released.
+     */
+    class buffer_lease {
+        friend class buffer_pool;
+
+        buffer_pool *pool = nullptr;
+        std::uint16_t id = {};
+        std::span<std::byte> bytes = {};
+
+        buffer_lease(buffer_pool *p, std::uint16_t i, std::span<std::byte> b)
+        : pool{p}, id{i}, bytes{b} {}
+
+
+      public:
+        buffer_lease() = default;
+        buffer_lease(buffer_lease const &) = delete;
+        buffer_lease(buffer_lease &&l)
+        : pool{std::exchange(l.pool, nullptr)},
+          id{l.id},
+          bytes{std::exchange(l.bytes, {})} {}
+        ~buffer_lease() { release(); }
+
+        buffer_lease &operator=(buffer_lease const &) = delete;
+        buffer_lease &operator=(buffer_lease &&l) {
+            if (this != &l) {
+                release();
+                pool = std::exchange(l.pool, nullptr);
+                id = l.id;
+                bytes = std::exchange(l.bytes, {});
+            }
+            return *this;
+        }
+
+        /// The bytes that were read
+        std::span<std::byte> data() const noexcept { return bytes; }
+        std::size_t size() const noexcept { return bytes.size(); }
+        /// An empty lease means the other end has closed the connection
+        bool empty() const noexcept { return bytes.empty(); }
+
+        /// Give the buffer back to the pool before the lease is destroyed
+        void release() noexcept;
+    };
+
+
+    /// ## Read buffer pool
+    /**
+     * A fixed number of equally sized read buffers carved out of a single
+     * allocation. A pooled read only takes a buffer once there is data for
+     * it, so connections that are waiting for data don't hold any read
+     * memory at all.
+     *
+     * Wardens own their pool. The `uring_warden` hands the buffers to the
+     * kernel so that it can pick one as data arrives, and the other wardens
+     * take one from the free list when the file descriptor becomes readable.
+     */
+    class buffer_pool {
+        friend class buffer_lease;
+
+
+      public:
+        /// ### Configuration
+        struct options {
+            /// The size of each buffer, and so the most a pooled read returns
+            std::size_t buffer_size = 4 << 10;
+            /// The number of buffers (`uring_warden` allows at most 32768)
+            std::uint16_t buffers = 256;
+        };
+
+        /// ### Statistics
+        struct statistics {
+            /// The number of buffers currently leased out
+            std::size_t in_use = {};
+            /// The most buffers that have been leased out at once
+            std::size_t high_water = {};
+            /// Reads that failed because every buffer was leased out
+            std::size_t exhausted = {};
+        };
+
+        explicit buffer_pool(options const &);
+        buffer_pool(buffer_pool const &) = delete;
+        buffer_pool &operator=(buffer_pool const &) = delete;
+        virtual ~buffer_pool();
+
+        options const &configuration() const noexcept { return config; }
+        statistics const &stats() const noexcept { return counters; }
+
+        /// ### Buffer management
+        /// Take a buffer off the free list, if there is one
+        std::optional<std::uint16_t> acquire() noexcept;
+        /// The memory for a buffer
+        std::span<std::byte> buffer(std::uint16_t const id) noexcept {
+            return {memory.get() + id * config.buffer_size, config.buffer_size};
+        }
+        /// Lease out the first `bytes` of a buffer that a read has filled
+        buffer_lease lease(std::uint16_t id, std::size_t bytes) noexcept;
+        /// Put back a buffer that isn't going to be leased
+        void give_back(std::uint16_t const id) noexcept { recycle(id); }
+        /// Record a read that failed because there were no buffers
+        void exhausted() noexcept { ++counters.exhausted; }
+
+
+      protected:
+        /// Make a buffer available again. The default puts it on the free list
+        virtual void recycle(std::uint16_t) noexcept;
+
+
+      private:
+        options const config;
+        std::unique_ptr<std::byte[]> memory;
+        std::vector<std::uint16_t> free;
+        statistics counters;
+    };
+
+
+    inline void buffer_lease::release() noexcept {
+        if (pool) {
+            --pool->counters.in_use;
+            std::exchange(pool, nullptr)->recycle(id);
+            bytes = {};
+        }
+    }
+
+
+}
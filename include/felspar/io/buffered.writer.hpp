@@ -0,0 +1,191 @@
+#pragma once
+
+
+#include <felspar/io/write.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace felspar::io {
+
+
+    struct buffered_writer_options {
+        /// Once this much is buffered it is sent without waiting
+        std::size_t flush_threshold = 16 << 10;
+        std::optional<std::chrono::nanoseconds> timeout = {};
+    };
+
+
+    /// ## Buffered writer
+    /**
+     * Gathers small writes to a socket (or anything else `write_all` works
+     * with, like `tls`) into a buffer. The buffer is sent once at the end of
+     * the warden loop iteration in which it was first written to, or straight
+     * away when it reaches the flush threshold, so that protocol code can
+     * write one field at a time without a system call for each of them.
+     *
+     * While the writer is corked nothing is sent until the threshold is
+     * reached or it is uncorked or flushed. Anything still buffered when the
+     * writer is destroyed is lost, so `flush` should be awaited first. An
+     * error from a flush made at the end of a loop iteration is thrown from
+     * the next `write` or `flush`.
+     *
+     * Several coroutines may write to the same writer. Only one send is ever
+     * in flight, and a flush made while another is sending waits for it.
+     *
+     * The stream must outlive the writer.
+     */
+    template<typename S>
+    class buffered_writer {
+        warden &ward;
+        S &stream;
+
+        std::vector<std::byte> buffer, outgoing;
+        bool ticking = false, sending = false, corked = false;
+        std::exception_ptr failed;
+
+        /// Coroutines waiting for the send in flight to finish
+        std::vector<felspar::coro::coroutine_handle<>> waiting;
+        struct send_finished {
+            buffered_writer &writer;
+            felspar::coro::coroutine_handle<> handle = {};
+            /// A waiter that is destroyed must not be resumed
+            ~send_finished() {
+                if (handle) { std::erase(writer.waiting, handle); }
+            }
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(felspar::coro::coroutine_handle<> const h) {
+                handle = h;
+                writer.waiting.push_back(h);
+            }
+            void await_resume() const noexcept {}
+        };
+        /// Ticks are kept until they finish, as a new one may start first
+        warden::starter<void> ticks;
+
+
+      public:
+        using options = buffered_writer_options;
+        options const settings;
+
+        struct statistics {
+            std::size_t writes = {};
+            /// The number of times buffered bytes have been sent
+            std::size_t flushes = {};
+        };
+
+
+        buffered_writer(warden &w, S &s) : buffered_writer{w, s, options{}} {}
+        buffered_writer(warden &w, S &s, options const &o)
+        : ward{w}, stream{s}, settings{o} {
+            buffer.reserve(settings.flush_threshold);
+        }
+        buffered_writer(buffered_writer const &) = delete;
+        buffered_writer &operator=(buffered_writer const &) = delete;
+
+
+        /// ### Writing
+        warden::task<void>
+                write(std::span<std::byte const> const bytes,
+                      felspar::source_location const &loc =
+                              felspar::source_location::current()) {
+            rethrow();
+            ++stats.writes;
+            buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+            if (buffer.size() >= settings.flush_threshold) {
+                co_await flush(loc);
+            } else if (not corked and not ticking) {
+                ticking = true;
+                ticks.garbage_collect_completed();
+                ticks.post(tick, this, loc);
+            }
+        }
+        warden::task<void>
+                write(std::string_view const s,
+                      felspar::source_location const &loc =
+                              felspar::source_location::current()) {
+            return write(std::as_bytes(std::span{s}), loc);
+        }
+
+        /// Send everything that has been buffered
+        warden::task<void>
+                flush(felspar::source_location const &loc =
+                              felspar::source_location::current()) {
+            rethrow();
+            co_await send(loc);
+            rethrow();
+        }
+
+        /// ### Corking
+        void cork() noexcept { corked = true; }
+        warden::task<void>
+                uncork(felspar::source_location const &loc =
+                               felspar::source_location::current()) {
+            corked = false;
+            return flush(loc);
+        }
+
+        /// The number of bytes waiting to be sent
+        std::size_t buffered() const noexcept { return buffer.size(); }
+        statistics const &counters() const noexcept { return stats; }
+
+
+      private:
+        statistics stats;
+
+        void rethrow() {
+            if (failed) { std::rethrow_exception(std::exchange(failed, {})); }
+        }
+
+        /**
+         * Bytes written while a send is going on are sent after it by the
+         * same send, and anyone else who wants to send waits for it. Errors
+         * are kept to be thrown from the next `write` or `flush`.
+         */
+        warden::task<void> send(felspar::source_location const &loc) {
+            while (sending) { co_await send_finished{*this}; }
+            if (failed) { co_return; }
+            sending = true;
+            try {
+                while (not buffer.empty()) {
+                    std::swap(buffer, outgoing);
+                    ++stats.flushes;
+                    co_await write_all(
+                            ward, stream,
+                            std::span<std::byte const>{outgoing},
+                            settings.timeout, loc);
+                    outgoing.clear();
+                }
+            } catch (...) {
+                outgoing.clear();
+                failed = std::current_exception();
+            }
+            sending = false;
+            /// Only those already waiting are resumed, as they may wait again
+            for (auto count = waiting.size(); count and not waiting.empty();
+                 --count) {
+                auto const h = waiting.front();
+                waiting.erase(waiting.begin());
+                h.resume();
+            }
+        }
+
+        /**
+         * Waiting for no time resumes at the end of the loop iteration. Once
+         * the tick starts sending, anything written after that needs another.
+         */
+        static warden::task<void>
+                tick(buffered_writer *self, felspar::source_location loc) {
+            co_await self->ward.sleep(std::chrono::nanoseconds{}, loc);
+            self->ticking = false;
+            if (not self->corked) { co_await self->send(loc); }
+        }
+    };
+
+
+}
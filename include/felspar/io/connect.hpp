@@ -1,7 +1,7 @@
 #pragma once
 
 
-#include <felspar/io/warden.hpp>
+#include <felspar/io/resolver.hpp>
 
 
 namespace felspar::io {
@@ -21,4 +21,31 @@ namespace felspar::io {
     }
 
 
+    /// ### Connect to a host by name
+    /**
+     * The name is looked up and each of its addresses is tried in turn until
+     * one of them accepts the connection. The time out applies to each
+     * connection attempt.
+     */
+    warden::task<posix::fd>
+            connect(warden &,
+                    resolver &,
+                    std::string host,
+                    std::uint16_t port,
+                    std::optional<std::chrono::nanoseconds> timeout = {},
+                    felspar::source_location const & =
+                            felspar::source_location::current());
+    FELSPAR_CORO_WRAPPER inline warden::task<posix::fd>
+            connect(warden &ward,
+                    std::string host,
+                    std::uint16_t const port,
+                    std::optional<std::chrono::nanoseconds> const timeout = {},
+                    felspar::source_location const &loc =
+                            felspar::source_location::current()) {
+        return connect(
+                ward, resolver::for_this_thread(), std::move(host), port,
+                timeout, loc);
+    }
+
+
 }
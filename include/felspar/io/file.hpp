@@ -0,0 +1,26 @@
+#pragma once
+
+
+#include <chrono>
+#include <cstdint>
+
+
+namespace felspar::io {
+
+
+    /// ## File status
+    /**
+     * What `warden::stat` reports about a file. This is the part of `statx`
+     * that is also available from `stat` on other systems.
+     */
+    struct file_status {
+        std::uint64_t size = {};
+        /// The file type and permission bits, as in `st_mode`
+        std::uint32_t mode = {};
+        std::uint32_t links = {};
+        std::uint64_t inode = {};
+        std::chrono::system_clock::time_point modified = {};
+    };
+
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+
+#include <felspar/memory/pmr.hpp>
+
+#include <cstddef>
+#include <vector>
+
+
+namespace felspar::io {
+
+
+    /// ## Coroutine frame pool
+    /**
+     * A size class slab allocator for coroutine frames. Frames are rounded up
+     * to a multiple of the `granularity` and carved out of slabs that are
+     * requested from the upstream allocator. Freed frames are kept on a free
+     * list for their size class and are only returned to the upstream
+     * allocator when the pool is destroyed.
+     *
+     * Frames larger than the largest size class, or with a stricter alignment
+     * than `std::max_align_t`, go straight to the upstream allocator.
+     *
+     * The pool is not thread safe. It is meant to be owned by a warden, which
+     * is only ever driven by one thread.
+     */
+    class frame_pool final : public felspar::pmr::memory_resource {
+      public:
+        static constexpr std::size_t granularity = 64;
+
+        /// ### Configuration
+        struct options {
+            /// Frames larger than this are not pooled
+            std::size_t largest_frame = 4 << 10;
+            /// The number of frames in each slab fetched from upstream
+            std::size_t frames_per_slab = 16;
+        };
+
+        /// ### Statistics
+        struct statistics {
+            /// Allocations served from a free list
+            std::size_t hits = {};
+            /// Allocations that needed memory from the upstream allocator
+            std::size_t misses = {};
+            /// The number of frames currently allocated
+            std::size_t in_use = {};
+            /// The most frames that have been allocated at once
+            std::size_t high_water = {};
+        };
+
+        explicit frame_pool(
+                options,
+                felspar::pmr::memory_resource *upstream =
+                        felspar::pmr::new_delete_resource());
+        frame_pool(frame_pool const &) = delete;
+        frame_pool &operator=(frame_pool const &) = delete;
+        ~frame_pool();
+
+        statistics const &stats() const noexcept { return counters; }
+
+
+      private:
+        struct node {
+            node *next;
+        };
+        struct slab {
+            void *memory;
+            std::size_t bytes;
+        };
+
+        options const config;
+        felspar::pmr::memory_resource *const upstream;
+        std::vector<node *> free;
+        std::vector<slab> slabs;
+        statistics counters;
+
+        bool pooled(std::size_t bytes, std::size_t alignment) const noexcept;
+        void refill(std::size_t size_class);
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(
+                void *p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(memory_resource const &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+
+}
@@ -3,7 +3,9 @@
 
 #include <felspar/io/warden.hpp>
 
+#include <algorithm>
 #include <span>
+#include <vector>
 
 #if __has_include(<unistd.h>)
 #include <unistd.h>
@@ -152,6 +154,41 @@ namespace felspar::io {
         }
         co_return b.size();
     }
+    /**
+     * Fill all of the buffers in order using vectored reads. After a partial
+     * read the buffers that were filled are skipped and the next is trimmed.
+     * No more than `warden::max_buffers` are read into by each IOP.
+     */
+    template<typename S>
+    inline warden::task<std::size_t> read_exactly(
+            warden &ward,
+            S &&sock,
+            std::span<std::span<std::byte> const> const buffers,
+            std::optional<std::chrono::nanoseconds> timeout = {},
+            felspar::source_location const &loc =
+                    felspar::source_location::current()) {
+        std::vector<std::span<std::byte>> in;
+        for (auto const b : buffers) {
+            if (not b.empty()) { in.push_back(b); }
+        }
+        std::span<std::span<std::byte>> pending{in};
+        std::size_t read{};
+        while (pending.size()) {
+            auto bytes = co_await ward.read_some_v(
+                    sock,
+                    pending.first(
+                            std::min(pending.size(), warden::max_buffers)),
+                    timeout, loc);
+            if (not bytes) { co_return read; }
+            read += bytes;
+            while (bytes and bytes >= pending.front().size()) {
+                bytes -= pending.front().size();
+                pending = pending.subspan(1);
+            }
+            if (bytes) { pending.front() = pending.front().subspan(bytes); }
+        }
+        co_return read;
+    }
     template<typename S>
     FELSPAR_CORO_WRAPPER inline warden::task<std::size_t> read_exactly(
             warden &w,
@@ -0,0 +1,48 @@
+#pragma once
+
+
+#include <cstddef>
+#include <span>
+
+
+namespace felspar::io {
+
+
+    /// ## Registered buffer
+    /**
+     * A handle to memory that has been registered with a warden, or to part of
+     * it. Wardens that can't register memory hand out handles without an
+     * index, and reads and writes through them behave just like `read_some`
+     * and `write_some`.
+     *
+     * The handle doesn't own the memory, which must outlive the registration.
+     */
+    class registered_buffer {
+        std::span<std::byte> bytes = {};
+        int index = -1;
+
+
+      public:
+        registered_buffer() = default;
+        registered_buffer(std::span<std::byte> const b, int const i)
+        : bytes{b}, index{i} {}
+
+        std::span<std::byte> data() const noexcept { return bytes; }
+        std::size_t size() const noexcept { return bytes.size(); }
+        /// The index of the registration, or -1 if the memory isn't registered
+        int native_index() const noexcept { return index; }
+
+        /// Handles for part of the buffer share its registration
+        registered_buffer first(std::size_t const count) const noexcept {
+            return {bytes.first(count), index};
+        }
+        registered_buffer subspan(
+                std::size_t const offset,
+                std::size_t const count =
+                        std::dynamic_extent) const noexcept {
+            return {bytes.subspan(offset, count), index};
+        }
+    };
+
+
+}
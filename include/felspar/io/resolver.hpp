@@ -0,0 +1,117 @@
+#pragma once
+
+
+#include <felspar/exceptions.hpp>
+#include <felspar/io/warden.hpp>
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace felspar::io {
+
+
+    struct resolver_options {
+        /// The name servers to ask. If empty they are read from `resolv_conf`
+        std::vector<sockaddr_in> servers = {};
+        /// Settings files, which are skipped if the path is empty
+        std::string resolv_conf = "/etc/resolv.conf";
+        std::string hosts = "/etc/hosts";
+
+        /// How long to wait for each server, and how many times to try them
+        std::chrono::nanoseconds timeout = std::chrono::seconds{5};
+        std::size_t attempts = 2;
+
+        /// Used for negative answers that don't say how long they last
+        std::chrono::nanoseconds negative_ttl = std::chrono::seconds{30};
+        /// Nothing is cached for longer than this
+        std::chrono::nanoseconds max_ttl = std::chrono::hours{1};
+    };
+
+
+    /// ## DNS resolver
+    /**
+     * Looks up the IPv4 addresses for a host name without blocking the
+     * warden. Numeric addresses and the names in the hosts file are answered
+     * straight away. Other names are sent as UDP queries to the name servers,
+     * and both the addresses found and names that don't exist are cached for
+     * as long as the server says they may be. Expired entries are dropped
+     * whenever a new answer is cached.
+     *
+     * A name that doesn't exist throws `host_not_found`, and if none of the
+     * servers answer the last error seen is thrown.
+     *
+     * The resolver keeps no locks, so each thread needs its own, which is
+     * what `for_this_thread` provides.
+     */
+    class resolver {
+        struct entry {
+            std::vector<in_addr> addresses;
+            std::chrono::steady_clock::time_point expires;
+        };
+        struct answer;
+
+        std::map<std::string, std::vector<in_addr>, std::less<>> hosts;
+        std::map<std::string, entry, std::less<>> cache;
+        std::minstd_rand ids;
+
+        warden::task<answer>
+                query(warden &,
+                      sockaddr_in const &,
+                      std::string const &,
+                      felspar::source_location const &);
+
+
+      public:
+        using options = resolver_options;
+        options settings;
+
+        struct statistics {
+            /// The number of queries sent to name servers
+            std::size_t queries = {};
+            std::size_t cache_hits = {};
+        };
+
+
+        /// The settings files are read by the constructor
+        resolver();
+        explicit resolver(options);
+
+        /// The resolver used by `connect` when none is given
+        static resolver &for_this_thread();
+
+
+        /// ### Look up a host name
+        warden::task<std::vector<in_addr>>
+                resolve(warden &,
+                        std::string host,
+                        felspar::source_location const & =
+                                felspar::source_location::current());
+
+        /// Forget everything that has been cached
+        void clear_cache() noexcept { cache.clear(); }
+        std::size_t cached() const noexcept { return cache.size(); }
+        statistics const &counters() const noexcept { return stats; }
+
+
+      private:
+        statistics stats;
+        void read_resolv_conf();
+        void read_hosts();
+    };
+
+
+    /// Thrown for names that the name server says don't exist
+    class host_not_found : public stdexcept::runtime_error {
+        using superclass = stdexcept::runtime_error;
+
+      public:
+        host_not_found(
+                std::string const &host, felspar::source_location const &loc)
+        : superclass{"Host not found: " + host, loc} {}
+    };
+
+
+}
@@ -1,7 +1,7 @@
 #pragma once
 
 
-#include <felspar/io/warden.hpp>
+#include <felspar/io/resolver.hpp>
 
 
 namespace felspar::io {
@@ -13,6 +13,13 @@ namespace felspar::io {
         std::unique_ptr<impl> p;
 
         explicit tls(std::unique_ptr<impl>);
+        /// Perform the client handshake over a connected socket
+        static warden::task<tls> handshake(
+                warden &,
+                posix::fd,
+                char const *sni_hostname,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &);
 
       public:
         tls();
@@ -33,6 +40,14 @@ namespace felspar::io {
                         std::optional<std::chrono::nanoseconds> timeout = {},
                         felspar::source_location const & =
                                 felspar::source_location::current());
+        /// The host name is looked up and also used for SNI
+        static warden::task<tls>
+                connect(warden &,
+                        std::string hostname,
+                        std::uint16_t port,
+                        std::optional<std::chrono::nanoseconds> timeout = {},
+                        felspar::source_location const & =
+                                felspar::source_location::current());
 
         /// Read from the connection
         warden::task<std::size_t> read_some(
@@ -0,0 +1,56 @@
+#pragma once
+
+
+#include <felspar/io/warden.poll.hpp>
+
+
+namespace felspar::io {
+
+
+    /// ## `epoll` based warden
+    /**
+     * This warden is only available on Linux. It shares all of its IOP
+     * implementations with the `poll_warden`, but rather than passing every
+     * waiting file descriptor to the kernel on each loop it keeps them
+     * registered with an `epoll` instance. Each loop only touches the file
+     * descriptors that have become ready, so the cost of running the loop
+     * scales with the amount of activity rather than the number of open
+     * connections.
+     *
+     * Registrations are one-shot and are re-armed whenever an IOP has to wait
+     * on a file descriptor. Files that `epoll` cannot wait on (for example
+     * regular files) are treated as always being ready.
+     *
+     * Unlike `poll`, `epoll` forgets about a file descriptor as soon as it is
+     * closed, so IOPs must not still be waiting on a file descriptor when it
+     * is closed or they will only complete when they time out.
+     */
+    class epoll_warden : public poll_warden {
+      public:
+        epoll_warden();
+        explicit epoll_warden(frame_pool::options const &);
+        ~epoll_warden();
+
+
+      protected:
+        void interest_changed(socket_descriptor, request &) override;
+        void do_poll(
+                std::optional<time_point> deadline,
+                std::vector<retrier *> &) override;
+
+
+      private:
+        struct epoll_data;
+        std::unique_ptr<epoll_data> epoll;
+
+        /// Move the first waiting IOP in each ready direction into the
+        /// continuations
+        void wake(
+                socket_descriptor,
+                bool reads,
+                bool writes,
+                std::vector<retrier *> &continuations);
+    };
+
+
+}
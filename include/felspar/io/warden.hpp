@@ -2,14 +2,23 @@
 
 #include <felspar/coro/starter.hpp>
 #include <felspar/coro/stream.hpp>
+#include <felspar/io/buffer.pool.hpp>
 #include <felspar/io/completion.hpp>
+#include <felspar/io/file.hpp>
+#include <felspar/io/frame.pool.hpp>
 #include <felspar/io/pipe.hpp>
 #include <felspar/io/posix.hpp>
+#include <felspar/io/registered.buffer.hpp>
 #include <felspar/memory/pmr.hpp>
 #include <felspar/test/source.hpp>
 
+#include <atomic>
 #include <chrono>
+#include <climits>
+#include <functional>
+#include <memory>
 #include <span>
+#include <vector>
 
 
 namespace felspar::io {
@@ -22,9 +31,11 @@ namespace felspar::io {
         friend class allocator;
         template<typename R>
         friend class felspar::io::iop;
+        friend coro::stream<socket_descriptor, warden> accept(
+                warden &, socket_descriptor, felspar::source_location);
 
       public:
-        virtual ~warden() = default;
+        virtual ~warden();
 
         template<typename R>
         using task = coro::task<R, warden>;
@@ -56,6 +67,26 @@ namespace felspar::io {
         /// processing is performed without any waits
         virtual void run_batch() = 0;
 
+        /// ### Coroutine frame pool
+        /**
+         * Coroutine frames are allocated from the warden. By default they go
+         * to the heap, but a warden constructed with `frame_pool::options`
+         * keeps freed frames for re-use instead. Frames must all be destroyed
+         * before the warden is.
+         */
+        frame_pool::statistics frame_statistics() const noexcept {
+            return frames ? frames->stats() : frame_pool::statistics{};
+        }
+
+        /// ### Loop statistics
+        struct loop_statistics {
+            /// The number of times the loop has waited for IO or timers
+            std::size_t waits = {};
+        };
+        loop_statistics const &statistics() const noexcept {
+            return loop_stats;
+        }
+
         /// ### File descriptors
         iop<void>
                 close(socket_descriptor fd,
@@ -69,14 +100,50 @@ namespace felspar::io {
                               felspar::source_location::current()) {
             return close(s.release(), loc);
         }
+        /**
+         * Cancel every IOP that is waiting on the file descriptor. Each of them
+         * fails with `ECANCELED`, and `accept` streams end. On io_uring the
+         * IOPs are cancelled in the kernel, which needs Linux 5.19 or later.
+         */
+        void cancel_all(
+                socket_descriptor fd,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            do_cancel_all(fd, loc);
+        }
+        void cancel_all(
+                posix::fd const &s,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            do_cancel_all(s.native_handle(), loc);
+        }
 
         /// ### Time management
+        /**
+         * A sleep with slack may end up to `slack` later than requested. This
+         * lets the warden wake once for sleeps whose deadlines are close
+         * together instead of once for each of them.
+         */
         iop<void>
                 sleep(std::chrono::nanoseconds ns,
                       felspar::source_location const &loc =
                               felspar::source_location::current()) {
-            return do_sleep(ns, loc);
+            return do_sleep(ns, {}, loc);
         }
+        iop<void>
+                sleep(std::chrono::nanoseconds ns,
+                      std::chrono::nanoseconds slack,
+                      felspar::source_location const &loc =
+                              felspar::source_location::current()) {
+            return do_sleep(ns, slack, loc);
+        }
+        /**
+         * The slack allowed for the time outs of IOPs started on this warden.
+         * With many connections arming time outs at slightly different times
+         * this allows them to be grouped together. When the warden is wrapped
+         * in an `allocator` it is the backing warden's slack that is used.
+         */
+        std::chrono::nanoseconds timeout_slack = {};
 
         /// ### Reading and writing
         /**
@@ -115,6 +182,282 @@ namespace felspar::io {
                         felspar::source_location::current()) {
             return write_some(s.native_handle(), b, timeout, l);
         }
+        /**
+         * Vectored reads and writes fill or send several buffers in order with
+         * a single IOP, so that something like a header and a body don't need
+         * two system calls or copying into one buffer. Just like `read_some`
+         * and `write_some` they may transfer fewer bytes than the buffers
+         * hold. The kernel refuses more than `max_buffers` buffers at a time.
+         */
+#ifdef IOV_MAX
+        static constexpr std::size_t max_buffers = IOV_MAX;
+#else
+        static constexpr std::size_t max_buffers = 1024;
+#endif
+        iop<std::size_t> read_some_v(
+                socket_descriptor fd,
+                std::span<std::span<std::byte> const> s,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_read_some_v(fd, s, timeout, loc);
+        }
+        iop<std::size_t> read_some_v(
+                posix::fd const &s,
+                std::span<std::span<std::byte> const> b,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &l =
+                        felspar::source_location::current()) {
+            return read_some_v(s.native_handle(), b, timeout, l);
+        }
+        iop<std::size_t> write_some_v(
+                socket_descriptor fd,
+                std::span<std::span<std::byte const> const> s,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_write_some_v(fd, s, timeout, loc);
+        }
+        iop<std::size_t> write_some_v(
+                posix::fd const &s,
+                std::span<std::span<std::byte const> const> b,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &l =
+                        felspar::source_location::current()) {
+            return write_some_v(s.native_handle(), b, timeout, l);
+        }
+        /**
+         * Send bytes on a socket without the kernel copying them. The IOP only
+         * completes once the kernel has released the buffer, so it can be
+         * re-used or freed straight away. The time out only applies until the
+         * bytes have been sent.
+         *
+         * Only one `send_zc` may be in progress on a socket at a time. The
+         * io_uring warden needs Linux 6.0 and the poll wardens use
+         * `MSG_ZEROCOPY`. Elsewhere this behaves like `write_some`. Copying is
+         * cheaper for small buffers, so this is only worth it for sends of
+         * around 10KB or more.
+         */
+        iop<std::size_t> send_zc(
+                socket_descriptor fd,
+                std::span<std::byte const> s,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_send_zc(fd, s, timeout, loc);
+        }
+        iop<std::size_t> send_zc(
+                posix::fd const &s,
+                std::span<std::byte const> b,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &l =
+                        felspar::source_location::current()) {
+            return send_zc(s.native_handle(), b, timeout, l);
+        }
+
+        /**
+         * Send up to `length` bytes of a file, starting at `offset`, to a
+         * socket without them being copied through user space. Returns the
+         * number of bytes sent, which is zero at the end of the file.
+         * `felspar::io::send_file` sends the whole range.
+         *
+         * io_uring splices the file through a pipe and the poll wardens use
+         * `sendfile`, which is only available on Linux.
+         */
+        iop<std::size_t> send_file_some(
+                socket_descriptor sock,
+                socket_descriptor file,
+                std::uint64_t const offset,
+                std::size_t const length,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_send_file_some(sock, file, offset, length, timeout, loc);
+        }
+        iop<std::size_t> send_file_some(
+                posix::fd const &sock,
+                posix::fd const &file,
+                std::uint64_t const offset,
+                std::size_t const length,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return send_file_some(
+                    sock.native_handle(), file.native_handle(), offset, length,
+                    timeout, loc);
+        }
+
+        /// ### Files
+        /**
+         * Positional reads and writes, opening, syncing and getting the status
+         * of files. Regular files are always "ready" as far as `poll` is
+         * concerned, so the poll wardens run these system calls on their
+         * offload threads rather than blocking the loop. io_uring does them
+         * in the kernel. There are no time outs because the system calls
+         * can't be interrupted part way through.
+         *
+         * The buffer for a read or write must stay alive until the IOP has
+         * completed, even if the IOP is destroyed before then.
+         */
+        iop<std::size_t> read_at(
+                socket_descriptor fd,
+                std::span<std::byte> b,
+                std::uint64_t const offset,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_read_at(fd, b, offset, loc);
+        }
+        iop<std::size_t> read_at(
+                posix::fd const &f,
+                std::span<std::byte> b,
+                std::uint64_t const offset,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_read_at(f.native_handle(), b, offset, loc);
+        }
+        iop<std::size_t> write_at(
+                socket_descriptor fd,
+                std::span<std::byte const> b,
+                std::uint64_t const offset,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_write_at(fd, b, offset, loc);
+        }
+        iop<std::size_t> write_at(
+                posix::fd const &f,
+                std::span<std::byte const> b,
+                std::uint64_t const offset,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_write_at(f.native_handle(), b, offset, loc);
+        }
+        /// The file descriptor is always opened with `O_CLOEXEC`
+        iop<socket_descriptor>
+                open(char const *path,
+                     int const flags,
+                     int const mode = 0,
+                     felspar::source_location const &loc =
+                             felspar::source_location::current()) {
+            return do_open(path, flags, mode, loc);
+        }
+        iop<void>
+                fsync(socket_descriptor fd,
+                      felspar::source_location const &loc =
+                              felspar::source_location::current()) {
+            return do_fsync(fd, false, loc);
+        }
+        iop<void>
+                fsync(posix::fd const &f,
+                      felspar::source_location const &loc =
+                              felspar::source_location::current()) {
+            return do_fsync(f.native_handle(), false, loc);
+        }
+        /// Only flushes the metadata that is needed to read the data back
+        iop<void> fdatasync(
+                socket_descriptor fd,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_fsync(fd, true, loc);
+        }
+        iop<void> fdatasync(
+                posix::fd const &f,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_fsync(f.native_handle(), true, loc);
+        }
+        iop<file_status>
+                stat(char const *path,
+                     felspar::source_location const &loc =
+                             felspar::source_location::current()) {
+            return do_stat(invalid_handle, path, loc);
+        }
+        iop<file_status>
+                stat(posix::fd const &f,
+                     felspar::source_location const &loc =
+                             felspar::source_location::current()) {
+            return do_stat(f.native_handle(), nullptr, loc);
+        }
+
+        /// ### Registered buffers
+        /**
+         * Memory that is used for a lot of large reads and writes can be
+         * registered with the warden. On io_uring this saves the kernel
+         * pinning and unpinning the pages for every IOP. Other wardens don't
+         * register anything and `read_fixed` and `write_fixed` behave like
+         * `read_some` and `write_some`.
+         *
+         * Registering replaces any buffers that were registered before, so
+         * their handles must no longer be used.
+         */
+        std::vector<registered_buffer> register_buffers(
+                std::span<std::span<std::byte> const> buffers,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_register_buffers(buffers, loc);
+        }
+        void unregister_buffers() { do_unregister_buffers(); }
+        iop<std::size_t> read_fixed(
+                socket_descriptor fd,
+                registered_buffer const &b,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_read_fixed(fd, b, timeout, loc);
+        }
+        iop<std::size_t> read_fixed(
+                posix::fd const &s,
+                registered_buffer const &b,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return read_fixed(s.native_handle(), b, timeout, loc);
+        }
+        iop<std::size_t> write_fixed(
+                socket_descriptor fd,
+                registered_buffer const &b,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_write_fixed(fd, b, timeout, loc);
+        }
+        iop<std::size_t> write_fixed(
+                posix::fd const &s,
+                registered_buffer const &b,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return write_fixed(s.native_handle(), b, timeout, loc);
+        }
+
+        /// ### Pooled reads
+        /**
+         * Read into a buffer from the warden's `buffer_pool` rather than one
+         * supplied by the caller. A buffer is only taken once data has
+         * arrived, so a connection waiting to read holds no read memory. The
+         * read fails with `ENOBUFS` if every buffer is leased out.
+         *
+         * The pool is created by the first pooled read using
+         * `read_buffer_options`. All leases must be released before the
+         * warden is destroyed.
+         */
+        buffer_pool::options read_buffer_options = {};
+        iop<buffer_lease> read_pooled(
+                socket_descriptor fd,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return do_read_pooled(fd, timeout, loc);
+        }
+        iop<buffer_lease> read_pooled(
+                posix::fd const &s,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return read_pooled(s.native_handle(), timeout, loc);
+        }
+        buffer_pool::statistics buffer_statistics() const noexcept {
+            return buffers ? buffers->stats() : buffer_pool::statistics{};
+        }
 
         /// ### Socket APIs
 
@@ -212,19 +555,45 @@ namespace felspar::io {
             return write_ready(sock.native_handle(), timeout, loc);
         }
 
+        /// ### Cross-thread posting
+        /**
+         * Apart from `post` a warden must only be used from the thread that
+         * runs its loop. `post` can be called from any thread, and the
+         * function is run on the warden's thread the next time the loop runs,
+         * waking the loop if it is waiting. Functions posted from the same
+         * thread run in the order they were posted. They must not throw.
+         *
+         * Posting doesn't take a lock. Functions still waiting when the
+         * warden is destroyed are never run.
+         */
+        void post(std::function<void()> f) { do_post(std::move(f)); }
+
       private:
+        /// ### Posted functions
+        struct posted {
+            std::function<void()> function;
+            posted *next;
+        };
+        std::atomic<posted *> inbox = {};
+
         /// ### PMR based memory allocation
+        std::unique_ptr<frame_pool> frames;
+        memory_resource *frame_allocator() const noexcept {
+            if (frames) {
+                return frames.get();
+            } else {
+                return felspar::pmr::new_delete_resource();
+            }
+        }
         void *do_allocate(
                 std::size_t const bytes, std::size_t const alignment) override {
-            return felspar::pmr::new_delete_resource()->allocate(
-                    bytes, alignment);
+            return frame_allocator()->allocate(bytes, alignment);
         }
         void do_deallocate(
                 void *const p,
                 std::size_t const bytes,
                 std::size_t const alignment) override {
-            return felspar::pmr::new_delete_resource()->deallocate(
-                    p, bytes, alignment);
+            return frame_allocator()->deallocate(p, bytes, alignment);
         }
         bool do_is_equal(memory_resource const &other) const noexcept override {
             return this == &other;
@@ -232,11 +601,34 @@ namespace felspar::io {
 
 
       protected:
+        warden() = default;
+        explicit warden(frame_pool::options const &o)
+        : frames{std::make_unique<frame_pool>(o)} {}
+
+        loop_statistics loop_stats;
+
+        /// The pool used by pooled reads, which is created when first needed
+        std::unique_ptr<buffer_pool> buffers;
+        buffer_pool &read_buffers() {
+            if (not buffers) {
+                buffers = make_buffer_pool(read_buffer_options);
+            }
+            return *buffers;
+        }
+        virtual std::unique_ptr<buffer_pool>
+                make_buffer_pool(buffer_pool::options const &o) {
+            return std::make_unique<buffer_pool>(o);
+        }
+
         virtual void run_until(felspar::coro::coroutine_handle<>) = 0;
         virtual iop<void> do_close(
                 socket_descriptor fd, felspar::source_location const &) = 0;
+        virtual void do_cancel_all(
+                socket_descriptor fd, felspar::source_location const &) = 0;
         virtual iop<void> do_sleep(
-                std::chrono::nanoseconds, felspar::source_location const &) = 0;
+                std::chrono::nanoseconds,
+                std::chrono::nanoseconds slack,
+                felspar::source_location const &) = 0;
         virtual iop<std::size_t> do_read_some(
                 socket_descriptor fd,
                 std::span<std::byte>,
@@ -247,6 +639,77 @@ namespace felspar::io {
                 std::span<std::byte const>,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &) = 0;
+        /// Without native support only the first non-empty buffer is used
+        virtual iop<std::size_t> do_read_some_v(
+                socket_descriptor fd,
+                std::span<std::span<std::byte> const>,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &);
+        virtual iop<std::size_t> do_write_some_v(
+                socket_descriptor fd,
+                std::span<std::span<std::byte const> const>,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &);
+        virtual iop<std::size_t> do_send_zc(
+                socket_descriptor fd,
+                std::span<std::byte const> b,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &loc) {
+            return do_write_some(fd, b, timeout, loc);
+        }
+        virtual iop<std::size_t> do_send_file_some(
+                socket_descriptor sock,
+                socket_descriptor file,
+                std::uint64_t offset,
+                std::size_t length,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) = 0;
+        virtual iop<std::size_t> do_read_at(
+                socket_descriptor fd,
+                std::span<std::byte>,
+                std::uint64_t offset,
+                felspar::source_location const &) = 0;
+        virtual iop<std::size_t> do_write_at(
+                socket_descriptor fd,
+                std::span<std::byte const>,
+                std::uint64_t offset,
+                felspar::source_location const &) = 0;
+        virtual iop<socket_descriptor> do_open(
+                char const *path,
+                int flags,
+                int mode,
+                felspar::source_location const &) = 0;
+        virtual iop<void> do_fsync(
+                socket_descriptor fd,
+                bool data_only,
+                felspar::source_location const &) = 0;
+        /// The status of the file at `path`, or of `fd` if `path` is null
+        virtual iop<file_status> do_stat(
+                socket_descriptor fd,
+                char const *path,
+                felspar::source_location const &) = 0;
+        virtual std::vector<registered_buffer> do_register_buffers(
+                std::span<std::span<std::byte> const>,
+                felspar::source_location const &);
+        virtual void do_unregister_buffers() {}
+        virtual iop<std::size_t> do_read_fixed(
+                socket_descriptor fd,
+                registered_buffer const &b,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &loc) {
+            return do_read_some(fd, b.data(), timeout, loc);
+        }
+        virtual iop<std::size_t> do_write_fixed(
+                socket_descriptor fd,
+                registered_buffer const &b,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &loc) {
+            return do_write_some(fd, b.data(), timeout, loc);
+        }
+        virtual iop<buffer_lease> do_read_pooled(
+                socket_descriptor fd,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) = 0;
         virtual void do_prepare_socket(
                 socket_descriptor, felspar::source_location const &) {}
         virtual iop<socket_descriptor> do_accept(
@@ -259,6 +722,13 @@ namespace felspar::io {
                 socklen_t,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &) = 0;
+        /**
+         * Produce connections for `felspar::io::accept`. The default issues
+         * one `do_accept` per connection, but wardens that can keep a single
+         * accept request running in the kernel override this.
+         */
+        virtual stream<socket_descriptor> do_accept_stream(
+                socket_descriptor fd, felspar::source_location const &);
         virtual iop<void> do_read_ready(
                 socket_descriptor fd,
                 std::optional<std::chrono::nanoseconds> timeout,
@@ -267,6 +737,28 @@ namespace felspar::io {
                 socket_descriptor fd,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &) = 0;
+
+        virtual void do_post(std::function<void()>);
+        /// Called from the posting thread to wake the loop
+        virtual void do_wake() noexcept = 0;
+        /// Run everything that has been posted, returning false if nothing was
+        bool run_posted() noexcept;
+    };
+
+
+    /// ### Resume on a warden
+    /**
+     * Awaiting this from a coroutine running on any thread continues it on
+     * the warden's thread.
+     */
+    struct resume_on {
+        warden &ward;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(felspar::coro::coroutine_handle<> h) {
+            ward.post([h]() { h.resume(); });
+        }
+        void await_resume() const noexcept {}
     };
 
 
@@ -3,13 +3,20 @@
 
 #include <felspar/io/warden.hpp>
 
-#include <map>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
 
 namespace felspar::io {
 
 
+    class recycler;
+
+
     /// ## `poll` based warden
     /**
      * This warden is compatible with both most POSIX systems and Windows
@@ -20,14 +27,8 @@ namespace felspar::io {
      * also needing to install signal handler.
      */
     class poll_warden : public warden {
-        struct retrier;
         template<typename R>
         struct completion;
-        struct request {
-            std::vector<retrier *> reads, writes;
-        };
-        std::map<socket_descriptor, request> requests;
-        std::multimap<std::chrono::steady_clock::time_point, retrier *> timeouts;
 
         void run_until(felspar::coro::coroutine_handle<>) override;
 
@@ -35,6 +36,18 @@ namespace felspar::io {
         struct sleep_completion;
         struct read_some_completion;
         struct write_some_completion;
+        struct read_some_v_completion;
+        struct write_some_v_completion;
+        struct send_zc_completion;
+        struct send_file_completion;
+        template<typename R>
+        struct file_completion;
+        struct read_at_completion;
+        struct write_at_completion;
+        struct open_completion;
+        struct fsync_completion;
+        struct stat_completion;
+        struct read_pooled_completion;
         struct accept_completion;
         struct connect_completion;
         struct read_ready_completion;
@@ -43,20 +56,50 @@ namespace felspar::io {
 
       public:
         poll_warden();
+        /// Allocate coroutine frames from a `frame_pool`
+        explicit poll_warden(frame_pool::options const &);
         ~poll_warden();
 
         void run_batch() override;
 
 
+        /// ### Blocking offload
+        /**
+         * Call a function that blocks, like `getaddrinfo`, on one of the
+         * warden's offload threads. The awaiting coroutine is continued on the
+         * warden's thread with the function's result, or its exception is
+         * re-thrown there.
+         *
+         * Up to `offload_threads` threads are started as they are needed.
+         * Calls that finish close together are handed back to the warden in
+         * one batch, which costs a single wake up of the loop.
+         *
+         * If the awaiting coroutine is destroyed while the function is
+         * running, the result is thrown away once it returns.
+         */
+        std::size_t offload_threads = 4;
+
+        template<typename F>
+        class offload_call;
+        template<typename F>
+        offload_call<F> offload(F f) {
+            return {*this, std::move(f)};
+        }
+
+
       protected:
         /// ### File descriptors
         iop<void> do_close(
                 socket_descriptor fd,
                 felspar::source_location const &) override;
+        void do_cancel_all(
+                socket_descriptor fd,
+                felspar::source_location const &) override;
 
         /// ### Time management
         iop<void> do_sleep(
                 std::chrono::nanoseconds,
+                std::chrono::nanoseconds slack,
                 felspar::source_location const &) override;
 
         /// ### Read & write
@@ -70,6 +113,55 @@ namespace felspar::io {
                 std::span<std::byte const>,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &) override;
+        iop<std::size_t> do_read_some_v(
+                socket_descriptor fd,
+                std::span<std::span<std::byte> const>,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_write_some_v(
+                socket_descriptor fd,
+                std::span<std::span<std::byte const> const>,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_send_zc(
+                socket_descriptor fd,
+                std::span<std::byte const>,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_send_file_some(
+                socket_descriptor sock,
+                socket_descriptor file,
+                std::uint64_t offset,
+                std::size_t length,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_read_at(
+                socket_descriptor fd,
+                std::span<std::byte>,
+                std::uint64_t offset,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_write_at(
+                socket_descriptor fd,
+                std::span<std::byte const>,
+                std::uint64_t offset,
+                felspar::source_location const &) override;
+        iop<socket_descriptor> do_open(
+                char const *path,
+                int flags,
+                int mode,
+                felspar::source_location const &) override;
+        iop<void> do_fsync(
+                socket_descriptor fd,
+                bool data_only,
+                felspar::source_location const &) override;
+        iop<file_status> do_stat(
+                socket_descriptor fd,
+                char const *path,
+                felspar::source_location const &) override;
+        iop<buffer_lease> do_read_pooled(
+                socket_descriptor fd,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
 
         /// ### Sockets
         void do_prepare_socket(
@@ -96,19 +188,169 @@ namespace felspar::io {
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &) override;
 
+        /// ### Cross-thread posting
+        void do_wake() noexcept override;
+
+
+        /// ### Readiness tracking
+        /**
+         * IOPs that can't complete immediately register a `retrier` against
+         * the file descriptor and direction they are waiting on. Sub-classes
+         * that use a different readiness API are told about any change through
+         * `interest_changed`, the default implementation of which keeps the
+         * `pollfd` array up to date.
+         *
+         * The requests are stored in a table indexed by file descriptor. As
+         * the kernel always hands out the lowest free file descriptor this
+         * stays about as large as the most file descriptors that have been
+         * open at once.
+         */
+        struct retrier;
+        struct request {
+            static constexpr std::size_t npos =
+                    std::numeric_limits<std::size_t>::max();
+            std::vector<retrier *> reads, writes;
+            /// The index of this file descriptor in the `pollfd` array
+            std::size_t pollfd = npos;
+        };
+        std::vector<request> requests;
+        request &request_for(socket_descriptor);
+
+        void add_reader(socket_descriptor, retrier *);
+        void add_writer(socket_descriptor, retrier *);
+        void remove_reader(socket_descriptor, retrier *);
+        void remove_writer(socket_descriptor, retrier *);
+        virtual void interest_changed(socket_descriptor, request &);
+
+        /// ### Waiting
+        /**
+         * Wait for readiness and add the IOPs that can proceed to `ready`. The
+         * wait must not end before the deadline unless something is ready.
+         * With no deadline the wait is indefinite.
+         */
+        using time_point = std::chrono::steady_clock::time_point;
+        virtual void do_poll(
+                std::optional<time_point> deadline,
+                std::vector<retrier *> &ready);
+        /// The loop's clock, which is read once per loop iteration
+        time_point loop_time() const noexcept;
+
 
       private:
         /// Used for managing the poll loop
         struct loop_data;
         std::unique_ptr<loop_data> bookkeeping;
+        /// Where completions are allocated from
+        recycler &completions() noexcept;
+        /// Start watching for other threads waking the loop
+        void watch_wakeups();
+
+        /// ### Blocking offload
+        /**
+         * System calls that `poll` can't wait for, like file IO, are made on
+         * the offload threads. The first is started the first time that one
+         * is needed.
+         */
+        struct offloaded;
+        class offload_pool;
+        offload_pool &offloader();
+        void submit_offloaded(offloaded *);
+        /// Called when the IOP or awaitable for the work is destroyed
+        void abandon_offloaded(offloaded *);
 
         /**
-         * Resume any coros that have now timed out and return the time out
-         * number to pass to poll
+         * Start the time out for the retrier. The deadline is relative to the
+         * loop's clock, which is only read once per loop iteration.
          */
-        int clear_timeouts();
-        /// Put together data for poll call and then process resulting `revents`
-        void do_poll(int timeout);
+        void schedule(
+                retrier *,
+                std::chrono::nanoseconds timeout,
+                std::chrono::nanoseconds slack);
+        /**
+         * Resume any coros that have now timed out and return the deadline of
+         * the next time out (if any)
+         */
+        std::optional<time_point> clear_timeouts();
+        /// Wait for readiness then read the clock and resume ready IOPs
+        void poll_and_resume(std::optional<time_point> deadline);
+    };
+
+
+    /// ### Offloaded work
+    struct poll_warden::offloaded {
+        enum class stage { queued, running, finished };
+        /// Only read or written with the offload pool's mutex held
+        stage state = stage::queued;
+        /// Set if the IOP is destroyed while an offload thread has this
+        bool abandoned = false;
+        /// True from being submitted until it is handed back to the warden.
+        /// This is only used on the warden's thread
+        bool submitted = false;
+
+        virtual ~offloaded() = default;
+        /// Make the blocking call. This is run on an offload thread
+        virtual void run() noexcept = 0;
+        /// Back on the warden's thread, return the coroutine to resume
+        virtual felspar::coro::coroutine_handle<> finish() = 0;
+    };
+
+
+    /// ### Awaitable for `offload`
+    template<typename F>
+    class poll_warden::offload_call {
+        using result_type = std::invoke_result_t<F>;
+
+        struct call final : public offloaded {
+            call(F f) : function{std::move(f)} {}
+
+            F function;
+            std::conditional_t<
+                    std::is_void_v<result_type>,
+                    std::monostate,
+                    std::optional<result_type>>
+                    value;
+            std::exception_ptr failed;
+            felspar::coro::coroutine_handle<> continuation;
+
+            void run() noexcept override {
+                try {
+                    if constexpr (std::is_void_v<result_type>) {
+                        function();
+                    } else {
+                        value.emplace(function());
+                    }
+                } catch (...) { failed = std::current_exception(); }
+            }
+            felspar::coro::coroutine_handle<> finish() override {
+                return continuation;
+            }
+        };
+
+        poll_warden &ward;
+        call *job;
+
+
+      public:
+        offload_call(poll_warden &w, F f)
+        : ward{w}, job{new call{std::move(f)}} {}
+        offload_call(offload_call const &) = delete;
+        offload_call &operator=(offload_call const &) = delete;
+        ~offload_call() {
+            if (job) { ward.abandon_offloaded(job); }
+        }
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(felspar::coro::coroutine_handle<> h) {
+            job->continuation = h;
+            ward.submit_offloaded(job);
+        }
+        result_type await_resume() {
+            std::unique_ptr<call> const done{std::exchange(job, nullptr)};
+            if (done->failed) { std::rethrow_exception(done->failed); }
+            if constexpr (not std::is_void_v<result_type>) {
+                return std::move(*done->value);
+            }
+        }
     };
 
 
@@ -0,0 +1,233 @@
+#pragma once
+
+
+#include <felspar/io/accept.hpp>
+#include <felspar/io/warden.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+
+namespace felspar::io {
+
+
+    /// ## Warden pool
+    /**
+     * Runs a warden of type `W` on each of a number of threads, one per core
+     * by default. `listen` gives every warden its own listening socket, all
+     * bound to the same port with `SO_REUSEPORT`, so that the kernel shares
+     * incoming connections out between them.
+     *
+     * `run` starts the coroutine once on every warden, on that warden's
+     * thread, and returns once they have all finished. If any of them throws
+     * the pool is stopped and the first exception is re-thrown from `run`.
+     *
+     * `stop` can be called from any thread, including from inside one of the
+     * coroutines. It cancels every IOP waiting on the listening sockets, which
+     * ends any `accept` streams on them. The pool's own `accept` stream also
+     * ends if it is asked for another connection after the stop, so it
+     * should be used for the listening sockets. Coroutines that wait on
+     * anything else should check `stop_requested`.
+     */
+    template<typename W>
+    class warden_pool {
+        /**
+         * Each warden is made, run and destroyed on its own thread, as some
+         * of them (like a `uring_warden` set up for a single issuer) must only
+         * ever be used from the thread that made them.
+         */
+        struct shard {
+            W *ward = nullptr;
+            posix::fd listener;
+            std::function<void(W &)> job;
+            std::exception_ptr failed;
+            std::thread thread;
+        };
+        std::vector<std::unique_ptr<shard>> shards;
+        std::atomic<bool> stopping = false;
+
+        std::mutex mutex;
+        std::condition_variable signal;
+        bool closing = false;
+        std::size_t finished = {};
+
+        template<typename... Args>
+        void serve(shard &sh, Args const &...args) {
+            std::optional<W> ward;
+            try {
+                ward.emplace(args...);
+            } catch (...) { sh.failed = std::current_exception(); }
+            std::unique_lock lock{mutex};
+            sh.ward = ward ? &*ward : nullptr;
+            ++finished;
+            signal.notify_all();
+            while (ward) {
+                signal.wait(lock, [&]() { return closing or sh.job; });
+                if (not sh.job) { break; }
+                auto job = std::exchange(sh.job, nullptr);
+                lock.unlock();
+                job(*ward);
+                lock.lock();
+                ++finished;
+                signal.notify_all();
+            }
+            sh.ward = nullptr;
+        }
+        /// Wait until every shard has finished what it was last given
+        void wait_for_shards() {
+            std::unique_lock lock{mutex};
+            signal.wait(lock, [this]() { return finished == shards.size(); });
+            finished = {};
+        }
+        void close() {
+            {
+                std::scoped_lock lock{mutex};
+                closing = true;
+            }
+            signal.notify_all();
+            for (auto &s : shards) { s->thread.join(); }
+        }
+
+
+      public:
+        static std::size_t cores() noexcept {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /**
+         * Any extra arguments are passed to each warden's constructor. If any
+         * of the wardens can't be made the first exception is re-thrown.
+         */
+        template<typename... Args>
+        explicit warden_pool(
+                std::size_t const threads = cores(), Args const &...args) {
+            shards.reserve(threads);
+            for (std::size_t index{}; index < threads; ++index) {
+                shards.push_back(std::make_unique<shard>());
+            }
+            for (auto &s : shards) {
+                s->thread = std::thread{[this, sh = s.get(), args...]() {
+                    serve(*sh, args...);
+                }};
+            }
+            wait_for_shards();
+            for (auto &s : shards) {
+                if (s->failed) {
+                    close();
+                    std::rethrow_exception(s->failed);
+                }
+            }
+        }
+        ~warden_pool() { close(); }
+        warden_pool(warden_pool const &) = delete;
+        warden_pool &operator=(warden_pool const &) = delete;
+
+
+        std::size_t size() const noexcept { return shards.size(); }
+        W &operator[](std::size_t const index) {
+            return *shards[index]->ward;
+        }
+
+
+        /// ### Sharded listening sockets
+        void
+                listen(std::uint16_t const port,
+                       int const backlog,
+                       felspar::source_location const &loc =
+                               felspar::source_location::current()) {
+            for (auto &s : shards) {
+                s->listener = s->ward->create_tcp_socket(loc);
+                posix::set_reuse_port(s->listener, loc);
+                posix::bind_to_any_address(s->listener, port, loc);
+                posix::listen(s->listener, backlog, loc);
+            }
+        }
+
+
+        /// ### Run a coroutine on every warden
+        /**
+         * The coroutine is given its warden and that warden's listening
+         * socket, which is invalid if `listen` hasn't been called. The other
+         * arguments are copied for each warden, so use `std::ref` for anything
+         * that is shared.
+         */
+        template<typename... PArgs, typename... MArgs>
+        void
+                run(warden::task<void> (*f)(
+                            warden &, posix::fd const &, PArgs...),
+                    MArgs const &...margs) {
+            std::exception_ptr failure;
+            {
+                std::scoped_lock lock{mutex};
+                for (auto &s : shards) {
+                    s->job = [&, sh = s.get()](W &ward) {
+                        try {
+                            ward.run(f, std::cref(sh->listener), margs...);
+                        } catch (...) {
+                            {
+                                std::scoped_lock lock{mutex};
+                                if (not failure) {
+                                    failure = std::current_exception();
+                                }
+                            }
+                            stop();
+                        }
+                    };
+                }
+            }
+            signal.notify_all();
+            wait_for_shards();
+            if (failure) { std::rethrow_exception(failure); }
+        }
+
+
+        /// ### Coordinated shut down
+        void stop() {
+            if (stopping.exchange(true)) { return; }
+            for (auto &s : shards) {
+                s->ward->post([sh = s.get()]() {
+                    if (sh->listener) { sh->ward->cancel_all(sh->listener); }
+                });
+            }
+        }
+        bool stop_requested() const noexcept { return stopping; }
+
+        /**
+         * Accept connections until the pool is stopped. The stop is checked
+         * on the warden's thread before each accept is started, and one that
+         * is already waiting is cancelled by `stop`, so none are missed.
+         */
+        warden::stream<socket_descriptor>
+                accept(warden &ward,
+                       posix::fd const &listener,
+                       felspar::source_location const &loc =
+                               felspar::source_location::current()) {
+            return accept_until_stopped(
+                    ward, listener.native_handle(), stopping, loc);
+        }
+
+
+      private:
+        static warden::stream<socket_descriptor> accept_until_stopped(
+                warden &ward,
+                socket_descriptor const listener,
+                std::atomic<bool> const &stopping,
+                felspar::source_location const loc) {
+            if (stopping) { co_return; }
+            auto accepting = io::accept(ward, listener, loc);
+            while (auto cnx = co_await accepting.next()) {
+                co_yield *cnx;
+                if (stopping) { co_return; }
+            }
+        }
+    };
+
+
+}
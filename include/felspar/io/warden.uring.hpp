@@ -14,32 +14,235 @@ namespace felspar::io {
         template<typename R>
         struct completion;
         struct impl;
+        struct wake_read;
         std::unique_ptr<impl> ring;
 
         struct close_completion;
         struct sleep_completion;
         struct read_some_completion;
         struct write_some_completion;
+        struct read_some_v_completion;
+        struct write_some_v_completion;
+        struct send_zc_completion;
+        struct send_file_completion;
+        struct read_at_completion;
+        struct write_at_completion;
+        struct open_completion;
+        struct fsync_completion;
+        struct stat_completion;
+        struct read_pooled_completion;
+        struct read_fixed_completion;
+        struct write_fixed_completion;
         struct accept_completion;
+        struct accept_multishot_completion;
+        struct accept_direct_completion;
         struct connect_completion;
         struct poll_completion;
 
+        class buffer_ring;
+        std::unique_ptr<buffer_pool>
+                make_buffer_pool(buffer_pool::options const &) override;
+
+        static stream<socket_descriptor> accept_multishot(
+                uring_warden &, socket_descriptor, felspar::source_location);
+
       public:
-        uring_warden() : uring_warden{100, {}} {}
+        /**
+         * With `IORING_SETUP_SQPOLL` a kernel thread takes SQEs from the ring
+         * as they're written, so submitting needs no system call while the
+         * thread is awake. The thread sleeps after it has been `idle` for a
+         * while, and the warden wakes it again when it next submits. It can be
+         * pinned to a `cpu`.
+         *
+         * The kernel must be able to poll normal file descriptors (Linux 5.11
+         * or later), otherwise the warden refuses to start. Polling can't be
+         * combined with `defer_taskrun`.
+         */
+        struct sq_poll {
+            std::chrono::milliseconds idle{1000};
+            /// The CPU to pin the polling thread to, if any
+            std::optional<unsigned> cpu = {};
+        };
+
+        /// ### Ring set up
+        /**
+         * The newer set up flags assume that only one thread ever uses the
+         * ring, which is always true of a warden. They need recent kernels,
+         * so they have to be asked for.
+         */
+        struct options {
+            unsigned entries = 256;
+            /// Any other `IORING_SETUP_*` flags
+            unsigned flags = {};
+            /// `IORING_SETUP_SINGLE_ISSUER`: only this thread submits
+            bool single_issuer = false;
+            /// `IORING_SETUP_DEFER_TASKRUN`: completion work is only done when
+            /// the warden waits. Implies `single_issuer`
+            bool defer_taskrun = false;
+            /// `IORING_SETUP_COOP_TASKRUN`: completions don't interrupt the
+            /// thread running the warden
+            bool coop_taskrun = false;
+            /// Register the ring's file descriptor so that entering the kernel
+            /// is cheaper
+            bool register_ring_fd = false;
+            /// Use a kernel thread to poll the submission queue
+            std::optional<sq_poll> polling = {};
+        };
+
+        uring_warden() : uring_warden{options{}} {}
+        explicit uring_warden(options const &);
         explicit uring_warden(unsigned entries, unsigned flags = {});
+        /// Allocate coroutine frames from a `frame_pool`
+        uring_warden(frame_pool::options const &, options const &);
+        explicit uring_warden(
+                frame_pool::options const &,
+                unsigned entries = 256,
+                unsigned flags = {});
         ~uring_warden();
 
         void run_batch() override;
 
+        /// ### Ring sizing
+        /**
+         * When the submission queue is full it is submitted early so that
+         * more SQEs become free. The completion queue is four times the size
+         * of the submission queue, and kernels with `IORING_FEAT_NODROP` keep
+         * completions that don't fit until there is space for them.
+         *
+         * If `grow_ring` is set and the submission queue has filled up, the
+         * ring is re-created large enough for the peak number of IOPs seen in
+         * flight. This only happens at the start of a `run` when nothing is in
+         * flight and nothing has been registered with the ring.
+         */
+        bool grow_ring = false;
+        struct uring_statistics {
+            /// The number of times a full submission queue was submitted early
+            std::size_t sq_full_submits = {};
+            /// Loop iterations that found completions waiting in the kernel
+            /// because the completion queue was full
+            std::size_t cq_overflows = {};
+            /// Completions that the kernel had to drop (only on kernels
+            /// without `IORING_FEAT_NODROP`)
+            std::size_t cqes_dropped = {};
+            /// SQEs submitted whose final CQE hasn't been seen yet
+            std::size_t in_flight = {};
+            std::size_t peak_in_flight = {};
+            /// The number of times the ring has been re-created larger
+            std::size_t resizes = {};
+            /// Calls to `io_uring_enter` made by the warden
+            std::size_t kernel_enters = {};
+            /// Times the submission queue polling thread had to be woken up
+            std::size_t sq_wakeups = {};
+            /// Abandoned IOPs that the kernel was asked to cancel
+            std::size_t cancellations = {};
+        };
+        uring_statistics const &ring_statistics() const noexcept;
+
+        /// ### Registered file descriptors
+        /**
+         * File descriptors that are used for many IOPs can be registered with
+         * the ring, which saves the kernel looking up the file for each IOP.
+         * The registration keeps the file open until the handle is destroyed,
+         * even if the original file descriptor has been closed.
+         *
+         * The first registration sets up a table of `fixed_file_slots` slots.
+         */
+        unsigned fixed_file_slots = 1024;
+        class fixed_fd {
+            friend class uring_warden;
+            uring_warden *ward = nullptr;
+            int index = -1;
+
+            fixed_fd(uring_warden *w, int i) : ward{w}, index{i} {}
+
+          public:
+            fixed_fd() = default;
+            fixed_fd(fixed_fd const &) = delete;
+            fixed_fd(fixed_fd &&f)
+            : ward{std::exchange(f.ward, nullptr)},
+              index{std::exchange(f.index, -1)} {}
+            ~fixed_fd() { reset(); }
+
+            fixed_fd &operator=(fixed_fd const &) = delete;
+            fixed_fd &operator=(fixed_fd &&f) {
+                if (this != &f) {
+                    reset();
+                    ward = std::exchange(f.ward, nullptr);
+                    index = std::exchange(f.index, -1);
+                }
+                return *this;
+            }
+
+            explicit operator bool() const noexcept { return ward != nullptr; }
+            /// The slot in the ring's file table
+            int native_index() const noexcept { return index; }
+
+            /// Remove the file from the ring's file table
+            void reset() noexcept;
+        };
+        fixed_fd register_fd(
+                socket_descriptor,
+                felspar::source_location const & =
+                        felspar::source_location::current());
+        fixed_fd register_fd(
+                posix::fd const &s,
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return register_fd(s.native_handle(), loc);
+        }
+
+        using warden::read_some;
+        iop<std::size_t> read_some(
+                fixed_fd const &,
+                std::span<std::byte>,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const & =
+                        felspar::source_location::current());
+        using warden::write_some;
+        iop<std::size_t> write_some(
+                fixed_fd const &,
+                std::span<std::byte const>,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const & =
+                        felspar::source_location::current());
+        using warden::accept;
+        /// Accept a connection on a registered listening socket
+        iop<socket_descriptor>
+                accept(fixed_fd const &,
+                       std::optional<std::chrono::nanoseconds> timeout = {},
+                       felspar::source_location const & =
+                               felspar::source_location::current());
+        /**
+         * Accept a connection straight into the ring's file table. The new
+         * connection has no normal file descriptor, so it can only be used
+         * through the `fixed_fd` APIs.
+         */
+        iop<fixed_fd> accept_direct(
+                socket_descriptor,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const & =
+                        felspar::source_location::current());
+        iop<fixed_fd> accept_direct(
+                posix::fd const &s,
+                std::optional<std::chrono::nanoseconds> timeout = {},
+                felspar::source_location const &loc =
+                        felspar::source_location::current()) {
+            return accept_direct(s.native_handle(), timeout, loc);
+        }
+
       protected:
         /// File descriptors
         iop<void> do_close(
                 socket_descriptor fd,
                 felspar::source_location const &) override;
+        void do_cancel_all(
+                socket_descriptor fd,
+                felspar::source_location const &) override;
 
         /// Time management
         iop<void> do_sleep(
                 std::chrono::nanoseconds,
+                std::chrono::nanoseconds slack,
                 felspar::source_location const &) override;
 
         /// Read & write
@@ -53,12 +256,78 @@ namespace felspar::io {
                 std::span<std::byte const>,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &) override;
+        iop<std::size_t> do_read_some_v(
+                socket_descriptor fd,
+                std::span<std::span<std::byte> const>,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_write_some_v(
+                socket_descriptor fd,
+                std::span<std::span<std::byte const> const>,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_send_zc(
+                socket_descriptor fd,
+                std::span<std::byte const>,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_send_file_some(
+                socket_descriptor sock,
+                socket_descriptor file,
+                std::uint64_t offset,
+                std::size_t length,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_read_at(
+                socket_descriptor fd,
+                std::span<std::byte>,
+                std::uint64_t offset,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_write_at(
+                socket_descriptor fd,
+                std::span<std::byte const>,
+                std::uint64_t offset,
+                felspar::source_location const &) override;
+        iop<socket_descriptor> do_open(
+                char const *path,
+                int flags,
+                int mode,
+                felspar::source_location const &) override;
+        iop<void> do_fsync(
+                socket_descriptor fd,
+                bool data_only,
+                felspar::source_location const &) override;
+        iop<file_status> do_stat(
+                socket_descriptor fd,
+                char const *path,
+                felspar::source_location const &) override;
+        std::vector<registered_buffer> do_register_buffers(
+                std::span<std::span<std::byte> const>,
+                felspar::source_location const &) override;
+        void do_unregister_buffers() override;
+        iop<std::size_t> do_read_fixed(
+                socket_descriptor fd,
+                registered_buffer const &,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<std::size_t> do_write_fixed(
+                socket_descriptor fd,
+                registered_buffer const &,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
+        iop<buffer_lease> do_read_pooled(
+                socket_descriptor fd,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &) override;
 
         /// Sockets
         iop<socket_descriptor> do_accept(
                 socket_descriptor fd,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &) override;
+        stream<socket_descriptor> do_accept_stream(
+                socket_descriptor fd,
+                felspar::source_location const &) override;
         iop<void> do_connect(
                 socket_descriptor fd,
                 sockaddr const *,
@@ -75,6 +344,9 @@ namespace felspar::io {
                 socket_descriptor fd,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &) override;
+
+        /// Cross-thread posting
+        void do_wake() noexcept override;
     };
 
 
@@ -0,0 +1,108 @@
+#pragma once
+
+
+#include <felspar/io/warden.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace felspar::io {
+
+
+    /// ## Work stealing pool
+    /**
+     * A pool of worker threads for CPU bound work that would otherwise stall
+     * a warden's loop. A coroutine awaiting `schedule` is continued on one of
+     * the workers. Each worker keeps its own lock-free deque of coroutines:
+     * it runs the newest first, and idle workers steal the oldest from the
+     * others, so that a burst of work landing on one worker is shared out.
+     * Work submitted from other threads to a busy worker can be taken by an
+     * idle one too.
+     *
+     * Nothing a coroutine does on a worker may touch a warden, so it has to
+     * `co_await resume_on{ward}` before its next IOP. `run_on_pool` does both
+     * hops around a single function call.
+     *
+     * Destroying the pool runs everything that has already been scheduled
+     * before the workers are joined.
+     */
+    class work_pool {
+        class worker;
+        std::vector<std::unique_ptr<worker>> workers;
+        std::atomic<std::size_t> next_worker = {};
+        std::atomic<bool> stopping = false;
+
+        void wake_idle(worker const *) noexcept;
+
+
+      public:
+        static std::size_t cores() noexcept {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        explicit work_pool(std::size_t threads = cores());
+        ~work_pool();
+        work_pool(work_pool const &) = delete;
+        work_pool &operator=(work_pool const &) = delete;
+
+
+        std::size_t size() const noexcept { return workers.size(); }
+        /// The number of coroutines that were taken from another worker
+        std::size_t steals() const noexcept;
+
+
+        /// ### Continue on a worker
+        void submit(felspar::coro::coroutine_handle<>);
+
+        struct awaitable {
+            work_pool &pool;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(felspar::coro::coroutine_handle<> h) {
+                pool.submit(h);
+            }
+            void await_resume() const noexcept {}
+        };
+        awaitable schedule() noexcept { return {*this}; }
+    };
+
+
+    /// ### Run a function on the pool
+    /**
+     * The coroutine moves onto the pool to call the function and then moves
+     * back onto the warden, where the result is returned or the exception
+     * re-thrown.
+     */
+    template<typename F>
+    inline warden::task<std::invoke_result_t<F>>
+            run_on_pool(warden &ward, work_pool &pool, F f) {
+        using result_type = std::invoke_result_t<F>;
+        std::exception_ptr failed;
+        if constexpr (std::is_void_v<result_type>) {
+            co_await pool.schedule();
+            try {
+                f();
+            } catch (...) { failed = std::current_exception(); }
+            co_await resume_on{ward};
+            if (failed) { std::rethrow_exception(failed); }
+        } else {
+            std::optional<result_type> result;
+            co_await pool.schedule();
+            try {
+                result.emplace(f());
+            } catch (...) { failed = std::current_exception(); }
+            co_await resume_on{ward};
+            if (failed) { std::rethrow_exception(failed); }
+            co_return std::move(*result);
+        }
+    }
+
+
+}
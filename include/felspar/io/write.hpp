@@ -4,7 +4,9 @@
 #include <felspar/coro/task.hpp>
 #include <felspar/io/warden.hpp>
 
+#include <algorithm>
 #include <span>
+#include <vector>
 
 
 namespace felspar::io {
@@ -52,6 +54,41 @@ namespace felspar::io {
         }
         co_return s.size();
     }
+    /**
+     * Write all of the buffers in order using vectored writes. After a partial
+     * write the buffers that went out are skipped and the next one is trimmed.
+     * No more than `warden::max_buffers` are written by each IOP.
+     */
+    template<typename S>
+    inline warden::task<std::size_t> write_all(
+            warden &ward,
+            S &&sock,
+            std::span<std::span<std::byte const> const> const buffers,
+            std::optional<std::chrono::nanoseconds> timeout = {},
+            felspar::source_location const &loc =
+                    felspar::source_location::current()) {
+        std::vector<std::span<std::byte const>> out;
+        for (auto const b : buffers) {
+            if (not b.empty()) { out.push_back(b); }
+        }
+        std::span<std::span<std::byte const>> pending{out};
+        std::size_t written{};
+        while (pending.size()) {
+            auto bytes = co_await ward.write_some_v(
+                    sock,
+                    pending.first(
+                            std::min(pending.size(), warden::max_buffers)),
+                    timeout, loc);
+            if (not bytes) { co_return written; }
+            written += bytes;
+            while (bytes and bytes >= pending.front().size()) {
+                bytes -= pending.front().size();
+                pending = pending.subspan(1);
+            }
+            if (bytes) { pending.front() = pending.front().subspan(bytes); }
+        }
+        co_return written;
+    }
     template<typename S>
     FELSPAR_CORO_WRAPPER inline warden::task<std::size_t> write_all(
             warden &w,
@@ -97,4 +134,38 @@ namespace felspar::io {
     }
 
 
+    /// ## Send a range of a file to a socket
+    inline warden::task<std::size_t> send_file(
+            warden &ward,
+            socket_descriptor const sock,
+            socket_descriptor const file,
+            std::uint64_t const offset,
+            std::size_t const length,
+            std::optional<std::chrono::nanoseconds> timeout = {},
+            felspar::source_location const &loc =
+                    felspar::source_location::current()) {
+        std::size_t sent{};
+        while (sent < length) {
+            auto const bytes = co_await ward.send_file_some(
+                    sock, file, offset + sent, length - sent, timeout, loc);
+            if (not bytes) { co_return sent; }
+            sent += bytes;
+        }
+        co_return sent;
+    }
+    FELSPAR_CORO_WRAPPER inline warden::task<std::size_t> send_file(
+            warden &ward,
+            posix::fd const &sock,
+            posix::fd const &file,
+            std::uint64_t const offset,
+            std::size_t const length,
+            std::optional<std::chrono::nanoseconds> timeout = {},
+            felspar::source_location const &loc =
+                    felspar::source_location::current()) {
+        return send_file(
+                ward, sock.native_handle(), file.native_handle(), offset,
+                length, std::move(timeout), loc);
+    }
+
+
 }
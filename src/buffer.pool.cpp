@@ -0,0 +1,40 @@
+#include <felspar/io/buffer.pool.hpp>
+
+#include <algorithm>
+
+
+felspar::io::buffer_pool::buffer_pool(options const &o)
+: config{o}, memory{new std::byte[o.buffer_size * o.buffers]} {
+    free.reserve(config.buffers);
+    for (std::size_t id{config.buffers}; id--;) {
+        free.push_back(static_cast<std::uint16_t>(id));
+    }
+}
+
+
+felspar::io::buffer_pool::~buffer_pool() = default;
+
+
+auto felspar::io::buffer_pool::acquire() noexcept
+        -> std::optional<std::uint16_t> {
+    if (free.empty()) {
+        return {};
+    } else {
+        auto const id = free.back();
+        free.pop_back();
+        return id;
+    }
+}
+
+
+auto felspar::io::buffer_pool::lease(
+        std::uint16_t const id, std::size_t const bytes) noexcept
+        -> buffer_lease {
+    counters.high_water = std::max(counters.high_water, ++counters.in_use);
+    return {this, id, buffer(id).first(bytes)};
+}
+
+
+void felspar::io::buffer_pool::recycle(std::uint16_t const id) noexcept {
+    free.push_back(id);
+}
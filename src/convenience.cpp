@@ -1,4 +1,5 @@
 #include <felspar/io/accept.hpp>
+#include <felspar/io/error.hpp>
 #include <felspar/io/pipe.hpp>
 #include <felspar/io/read.hpp>
 #include <felspar/io/warden.hpp>
@@ -7,31 +8,51 @@
 #include <felspar/exceptions.hpp>
 
 
-felspar::io::warden::stream<felspar::io::socket_descriptor> felspar::io::accept(
-        warden &ward, socket_descriptor fd, felspar::source_location loc) {
-    /**
-     * Because this is a coroutine it must take the source location by copy not
-     * by reference, as the referenced source location would go out of scope
-     * before it can be used in this coroutine.
-     */
-    while (true) {
-        auto s = co_await ward.accept(fd, {}, loc);
+namespace {
+    felspar::io::warden::stream<felspar::io::socket_descriptor> accept_loop(
+            felspar::io::warden &ward,
+            felspar::io::socket_descriptor fd,
+            felspar::source_location loc) {
+        /**
+         * Because this is a coroutine it must take the source location by
+         * copy not by reference, as the referenced source location would go
+         * out of scope before it can be used in this coroutine.
+         */
+        while (true) {
+            auto accepted = co_await felspar::io::ec{ward.accept(fd, {}, loc)};
+            /// `cancel_all` on the socket ends the stream
+            if (accepted.error == std::errc::operation_canceled) { co_return; }
+            auto const s = std::move(accepted).value(loc);
 #if defined(FELSPAR_WINSOCK2)
-        co_yield s;
-#else
-        if (s >= 0) {
             co_yield s;
-        } else if (s != -EBADF) {
-            throw felspar::stdexcept::system_error{
-                    -s, std::system_category(), "accept", loc};
-        } else {
-            co_return;
-        }
+#else
+            if (s >= 0) {
+                co_yield s;
+            } else if (s != -EBADF) {
+                throw felspar::stdexcept::system_error{
+                        -s, std::system_category(), "accept", loc};
+            } else {
+                co_return;
+            }
 #endif
+        }
     }
 }
 
 
+felspar::io::warden::stream<felspar::io::socket_descriptor>
+        felspar::io::warden::do_accept_stream(
+                socket_descriptor fd, felspar::source_location const &loc) {
+    return accept_loop(*this, fd, loc);
+}
+
+
+felspar::io::warden::stream<felspar::io::socket_descriptor> felspar::io::accept(
+        warden &ward, socket_descriptor fd, felspar::source_location loc) {
+    return ward.do_accept_stream(fd, loc);
+}
+
+
 std::size_t felspar::io::write_some(
         socket_descriptor sock,
         void const *const data,
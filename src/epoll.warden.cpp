@@ -0,0 +1,180 @@
+#include "poll.hpp"
+
+#include <felspar/exceptions.hpp>
+#include <felspar/io/warden.epoll.hpp>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+
+struct felspar::io::epoll_warden::epoll_data {
+    posix::fd epfd;
+    /// Grows whenever a call to `epoll_wait` fills it
+    std::vector<::epoll_event> events = std::vector<::epoll_event>(64);
+    /// File descriptors that `epoll` refuses to track
+    std::vector<socket_descriptor> always_ready, processing;
+    /**
+     * `epoll_wait` only takes a time out in milliseconds, so deadlines are
+     * handled by a `timerfd` on the monotonic clock (which is the clock used
+     * by `std::chrono::steady_clock`).
+     */
+    posix::fd timer;
+    std::optional<time_point> armed;
+
+    epoll_data() {
+        epfd = posix::fd{::epoll_create1(EPOLL_CLOEXEC)};
+        if (not epfd) {
+            throw felspar::stdexcept::system_error{
+                    get_error(), std::system_category(), "epoll_create1"};
+        }
+        timer = posix::fd{
+                ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)};
+        if (not timer) {
+            throw felspar::stdexcept::system_error{
+                    get_error(), std::system_category(), "timerfd_create"};
+        }
+        ::epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = timer.native_handle();
+        if (::epoll_ctl(
+                    epfd.native_handle(), EPOLL_CTL_ADD, timer.native_handle(),
+                    &ev)
+            != 0) {
+            throw felspar::stdexcept::system_error{
+                    get_error(), std::system_category(), "epoll_ctl/timerfd"};
+        }
+    }
+};
+
+
+felspar::io::epoll_warden::epoll_warden()
+: epoll{std::make_unique<epoll_data>()} {}
+felspar::io::epoll_warden::epoll_warden(frame_pool::options const &o)
+: poll_warden{o}, epoll{std::make_unique<epoll_data>()} {}
+
+
+felspar::io::epoll_warden::~epoll_warden() = default;
+
+
+void felspar::io::epoll_warden::interest_changed(
+        socket_descriptor const fd, request &req) {
+    ::epoll_event ev{};
+    if (not req.reads.empty()) { ev.events |= EPOLLIN | EPOLLRDHUP; }
+    if (not req.writes.empty()) { ev.events |= EPOLLOUT; }
+    if (not ev.events) {
+        /**
+         * Nothing is waiting any more. Leaving the registration armed costs at
+         * most one spurious event, which is cheaper than another `epoll_ctl`.
+         */
+        return;
+    }
+    ev.events |= EPOLLONESHOT;
+    ev.data.fd = fd;
+
+    auto const efd = epoll->epfd.native_handle();
+    if (::epoll_ctl(efd, EPOLL_CTL_MOD, fd, &ev) == 0) {
+        return;
+    } else if (
+            get_error() == ENOENT
+            and ::epoll_ctl(efd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+        return;
+    } else if (auto const error = get_error();
+               error == EPERM or error == EBADF) {
+        /**
+         * The IOP will be retried on the next loop. For files that can't be
+         * polled it will then succeed, and for bad file descriptors it will
+         * report the error.
+         */
+        epoll->always_ready.push_back(fd);
+    } else {
+        throw felspar::stdexcept::system_error{
+                error, std::system_category(), "epoll_ctl"};
+    }
+}
+
+
+void felspar::io::epoll_warden::do_poll(
+        std::optional<time_point> const deadline,
+        std::vector<retrier *> &continuations) {
+    int timeout = -1;
+    if (not epoll->always_ready.empty()
+        or (deadline and *deadline <= loop_time())) {
+        timeout = 0;
+    } else if (deadline and deadline != epoll->armed) {
+        auto const since = deadline->time_since_epoch();
+        auto const seconds =
+                std::chrono::duration_cast<std::chrono::seconds>(since);
+        ::itimerspec const when{
+                {},
+                {static_cast<::time_t>(seconds.count()),
+                 static_cast<long>((since - seconds).count())}};
+        if (::timerfd_settime(
+                    epoll->timer.native_handle(), TFD_TIMER_ABSTIME, &when,
+                    nullptr)
+            != 0) {
+            throw felspar::stdexcept::system_error{
+                    get_error(), std::system_category(), "timerfd_settime"};
+        }
+        epoll->armed = deadline;
+    }
+
+    auto &events = epoll->events;
+    int const ready = ::epoll_wait(
+            epoll->epfd.native_handle(), events.data(), events.size(),
+            timeout);
+    if (ready < 0) {
+        if (auto const error = get_error(); error == EINTR) {
+            return;
+        } else {
+            throw felspar::stdexcept::system_error{
+                    error, std::system_category(), "epoll_wait"};
+        }
+    }
+
+    for (auto const &event : std::span{events.data(), std::size_t(ready)}) {
+        if (event.data.fd == epoll->timer.native_handle()) {
+            std::uint64_t expirations{};
+            if (::read(event.data.fd, &expirations, sizeof(expirations)) < 0
+                and get_error() != EAGAIN) {
+                throw felspar::stdexcept::system_error{
+                        get_error(), std::system_category(), "timerfd read"};
+            }
+            epoll->armed.reset();
+            continue;
+        }
+        wake(event.data.fd,
+             event.events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP),
+             event.events & (EPOLLOUT | EPOLLERR | EPOLLHUP),
+             continuations);
+    }
+    epoll->processing.swap(epoll->always_ready);
+    for (auto const fd : epoll->processing) {
+        wake(fd, true, true, continuations);
+    }
+    epoll->processing.clear();
+    if (std::size_t(ready) == events.size()) {
+        events.resize(events.size() * 2);
+    }
+}
+
+
+void felspar::io::epoll_warden::wake(
+        socket_descriptor const fd,
+        bool const reads,
+        bool const writes,
+        std::vector<retrier *> &continuations) {
+    auto &req = request_for(fd);
+    /// Only one IOP per direction is woken, any others are woken later
+    if (reads and not req.reads.empty()) {
+        continuations.push_back(req.reads.front());
+        req.reads.erase(req.reads.begin());
+    }
+    if (writes and not req.writes.empty()) {
+        continuations.push_back(req.writes.front());
+        req.writes.erase(req.writes.begin());
+    }
+    /// The one-shot registration has fired so re-arm it for any waiters left
+    if (not req.reads.empty() or not req.writes.empty()) {
+        interest_changed(fd, req);
+    }
+}
@@ -0,0 +1,78 @@
+#include <felspar/io/frame.pool.hpp>
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+
+namespace {
+    std::size_t size_class(std::size_t const bytes) noexcept {
+        return (std::max<std::size_t>(bytes, 1) - 1)
+                / felspar::io::frame_pool::granularity;
+    }
+}
+
+
+felspar::io::frame_pool::frame_pool(
+        options const o, felspar::pmr::memory_resource *const u)
+: config{o.largest_frame, std::max<std::size_t>(o.frames_per_slab, 1)},
+  upstream{u},
+  free(config.largest_frame ? size_class(config.largest_frame) + 1 : 0) {}
+
+
+felspar::io::frame_pool::~frame_pool() {
+    for (auto const &s : slabs) {
+        upstream->deallocate(s.memory, s.bytes, alignof(std::max_align_t));
+    }
+}
+
+
+bool felspar::io::frame_pool::pooled(
+        std::size_t const bytes, std::size_t const alignment) const noexcept {
+    return not free.empty() and bytes <= config.largest_frame
+            and alignment <= alignof(std::max_align_t);
+}
+
+
+void felspar::io::frame_pool::refill(std::size_t const sc) {
+    std::size_t const frame = (sc + 1) * granularity;
+    std::size_t const bytes = frame * config.frames_per_slab;
+    slabs.reserve(slabs.size() + 1);
+    auto *const memory = static_cast<std::byte *>(
+            upstream->allocate(bytes, alignof(std::max_align_t)));
+    slabs.push_back({memory, bytes});
+    for (std::size_t index{config.frames_per_slab}; index--;) {
+        free[sc] = ::new (memory + index * frame) node{free[sc]};
+    }
+}
+
+
+void *felspar::io::frame_pool::do_allocate(
+        std::size_t const bytes, std::size_t const alignment) {
+    void *frame = nullptr;
+    if (not pooled(bytes, alignment)) {
+        frame = upstream->allocate(bytes, alignment);
+        ++counters.misses;
+    } else if (auto const sc = size_class(bytes); free[sc]) {
+        frame = std::exchange(free[sc], free[sc]->next);
+        ++counters.hits;
+    } else {
+        refill(sc);
+        frame = std::exchange(free[sc], free[sc]->next);
+        ++counters.misses;
+    }
+    counters.high_water = std::max(counters.high_water, ++counters.in_use);
+    return frame;
+}
+
+
+void felspar::io::frame_pool::do_deallocate(
+        void *const p, std::size_t const bytes, std::size_t const alignment) {
+    if (pooled(bytes, alignment)) {
+        auto const sc = size_class(bytes);
+        free[sc] = ::new (p) node{free[sc]};
+    } else {
+        upstream->deallocate(p, bytes, alignment);
+    }
+    --counters.in_use;
+}
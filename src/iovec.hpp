@@ -0,0 +1,28 @@
+#pragma once
+
+
+#include <span>
+#include <vector>
+
+#include <sys/uio.h>
+
+
+namespace felspar::io {
+
+
+    /// The buffers of a vectored IOP as the kernel wants them described
+    template<typename B>
+    inline std::vector<::iovec>
+            iovecs_for(std::span<std::span<B> const> const buffers) {
+        std::vector<::iovec> iovecs;
+        iovecs.reserve(buffers.size());
+        for (auto const b : buffers) {
+            iovecs.push_back(
+                    {const_cast<void *>(static_cast<void const *>(b.data())),
+                     b.size()});
+        }
+        return iovecs;
+    }
+
+
+}
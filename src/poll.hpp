@@ -4,44 +4,53 @@
 #include <felspar/io/exceptions.hpp>
 #include <felspar/io/warden.poll.hpp>
 
+#include "recycler.hpp"
+#include "timers.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 
 namespace felspar::io {
 
 
-    struct poll_warden::retrier {
+    /// The timer is used for the IOP's time out (or the sleep)
+    struct poll_warden::retrier : public timer_wheel::timer {
         virtual felspar::coro::coroutine_handle<> try_or_resume() = 0;
         virtual felspar::coro::coroutine_handle<> iop_timedout() = 0;
+        virtual felspar::coro::coroutine_handle<> iop_cancelled() = 0;
     };
 
 
     template<typename R>
-    struct poll_warden::completion : public retrier, public io::completion<R> {
+    struct poll_warden::completion :
+    public retrier,
+            public io::completion<R>,
+            public recyclable {
         completion(
                 poll_warden *w,
                 std::optional<std::chrono::nanoseconds> t,
                 felspar::source_location const &loc)
-        : io::completion<R>{loc}, self{w}, timeout{t} {}
+        : io::completion<R>{loc},
+          self{w},
+          timeout{t},
+          slack{w->timeout_slack} {}
 
         poll_warden *self;
         warden *ward() override { return self; }
 
         std::optional<std::chrono::nanoseconds> timeout = {};
+        std::chrono::nanoseconds slack;
 
+        /// A retried IOP keeps the deadline it was first given
         void insert_timeout() {
-            if (timeout) {
-                auto const deadline =
-                        std::chrono::steady_clock::now() + *timeout;
-                self->timeouts.insert({deadline, this});
-            }
-        }
-        void cancel_timeout() {
-            if (timeout) {
-                auto pos = std::find_if(
-                        self->timeouts.begin(), self->timeouts.end(),
-                        [this](auto const &s) { return s.second == this; });
-                if (pos != self->timeouts.end()) { self->timeouts.erase(pos); }
+            if (timeout and not is_linked()) {
+                self->schedule(this, *timeout, slack);
             }
         }
+        void cancel_timeout() { timer_wheel::cancel(*this); }
         virtual void cancel_iop() = 0;
 
         felspar::coro::coroutine_handle<>
@@ -55,6 +64,14 @@ namespace felspar::io {
             io::completion<R>::result = {timeout::error, "IOP timed out"};
             return io::completion<R>::handle;
         }
+        felspar::coro::coroutine_handle<> iop_cancelled() override {
+            cancel_timeout();
+            cancel_iop();
+            io::completion<R>::result = {
+                    std::error_code{ECANCELED, std::system_category()},
+                    "IOP cancelled"};
+            return io::completion<R>::handle;
+        }
         felspar::coro::coroutine_handle<> cancel_timeout_then_resume() {
             cancel_timeout();
             return io::completion<R>::handle;
@@ -67,6 +84,42 @@ namespace felspar::io {
         }
     };
 
+    /**
+     * Work is queued for the offload threads. Finished work is gathered up
+     * and handed back to the warden by posting to it, so that everything
+     * which finishes before the warden gets round to it is resumed after a
+     * single wake up.
+     */
+    class poll_warden::offload_pool {
+        poll_warden &ward;
+        std::size_t const most_threads;
+
+        std::mutex mutex;
+        std::condition_variable signal;
+        std::deque<offloaded *> queued;
+        std::vector<offloaded *> finished, resuming;
+        std::size_t idle = {};
+        bool stopping = false;
+        std::vector<std::thread> threads;
+
+        void work();
+        void resume_finished();
+
+
+      public:
+        offload_pool(poll_warden &, std::size_t most_threads);
+        ~offload_pool();
+
+        void submit(offloaded *);
+        /**
+         * Take back work whose IOP has been destroyed. Returns false if an
+         * offload thread is busy with it, in which case it will be deleted
+         * once it has finished.
+         */
+        bool withdraw(offloaded *);
+    };
+
+
     /// These are used to smooth over some Windows/POSIX differences
     inline bool would_block(auto const err) {
 #ifdef FELSPAR_WINSOCK2
@@ -3,6 +3,24 @@
 #include <felspar/exceptions.hpp>
 #include <felspar/io/connect.hpp>
 
+#include <string>
+
+#if not defined(FELSPAR_WINSOCK2)
+#include "iovec.hpp"
+#endif
+#if __has_include(<sys/sendfile.h>)
+#include <sys/sendfile.h>
+#endif
+#if not defined(FELSPAR_WINSOCK2)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if __has_include(<linux/errqueue.h>)
+#include <linux/errqueue.h>
+#include <sys/socket.h>
+#endif
+
 
 struct felspar::io::poll_warden::close_completion : public completion<void> {
     close_completion(
@@ -23,7 +41,7 @@ struct felspar::io::poll_warden::close_completion : public completion<void> {
 };
 felspar::io::iop<void> felspar::io::poll_warden::do_close(
         socket_descriptor fd, felspar::source_location const &loc) {
-    return {new close_completion{this, fd, loc}};
+    return {new (completions()) close_completion{this, fd, loc}};
 }
 
 
@@ -31,8 +49,11 @@ struct felspar::io::poll_warden::sleep_completion : public completion<void> {
     sleep_completion(
             poll_warden *s,
             std::chrono::nanoseconds ns,
+            std::chrono::nanoseconds sl,
             felspar::source_location const &loc)
-    : completion<void>{s, ns, loc} {}
+    : completion<void>{s, ns, loc} {
+        slack = sl;
+    }
     void cancel_iop() override {}
     felspar::coro::coroutine_handle<> iop_timedout() override {
         return io::completion<void>::handle;
@@ -42,8 +63,10 @@ struct felspar::io::poll_warden::sleep_completion : public completion<void> {
     }
 };
 felspar::io::iop<void> felspar::io::poll_warden::do_sleep(
-        std::chrono::nanoseconds ns, felspar::source_location const &loc) {
-    return {new sleep_completion{this, ns, loc}};
+        std::chrono::nanoseconds ns,
+        std::chrono::nanoseconds slack,
+        felspar::source_location const &loc) {
+    return {new (completions()) sleep_completion{this, ns, slack, loc}};
 }
 
 
@@ -58,7 +81,7 @@ public completion<std::size_t> {
     : completion<std::size_t>{s, timeout, loc}, fd{f}, buf{b} {}
     socket_descriptor fd;
     std::span<std::byte> buf;
-    void cancel_iop() override { std::erase(self->requests[fd].reads, this); }
+    void cancel_iop() override { self->remove_reader(fd, this); }
     felspar::coro::coroutine_handle<> try_or_resume() override {
 #ifdef FELSPAR_WINSOCK2
         if (auto const bytes = recv(
@@ -70,7 +93,7 @@ public completion<std::size_t> {
             result = bytes;
             return cancel_timeout_then_resume();
         } else if (auto const error = get_error(); would_block(error)) {
-            self->requests[fd].reads.push_back(this);
+            self->add_reader(fd, this);
             return felspar::coro::noop_coroutine();
         } else {
             result = {{error, std::system_category()}, "read"};
@@ -83,7 +106,115 @@ felspar::io::iop<std::size_t> felspar::io::poll_warden::do_read_some(
         std::span<std::byte> buf,
         std::optional<std::chrono::nanoseconds> timeout,
         felspar::source_location const &loc) {
-    return {new read_some_completion{this, fd, buf, timeout, loc}};
+    return {new (completions())
+                    read_some_completion{this, fd, buf, timeout, loc}};
+}
+
+
+#if not defined(FELSPAR_WINSOCK2)
+struct felspar::io::poll_warden::read_some_v_completion :
+public completion<std::size_t> {
+    read_some_v_completion(
+            poll_warden *s,
+            socket_descriptor f,
+            std::span<std::span<std::byte> const> b,
+            std::optional<std::chrono::nanoseconds> timeout,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, timeout, loc}, fd{f}, iovecs{iovecs_for(b)} {}
+    socket_descriptor fd;
+    std::vector<::iovec> iovecs;
+    void cancel_iop() override { self->remove_reader(fd, this); }
+    felspar::coro::coroutine_handle<> try_or_resume() override {
+        if (auto const bytes = ::readv(fd, iovecs.data(), iovecs.size());
+            bytes >= 0) {
+            result = bytes;
+            return cancel_timeout_then_resume();
+        } else if (auto const error = get_error(); would_block(error)) {
+            self->add_reader(fd, this);
+            return felspar::coro::noop_coroutine();
+        } else {
+            result = {{error, std::system_category()}, "readv"};
+            return cancel_timeout_then_resume();
+        }
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_read_some_v(
+        socket_descriptor fd,
+        std::span<std::span<std::byte> const> bufs,
+        std::optional<std::chrono::nanoseconds> timeout,
+        felspar::source_location const &loc) {
+    return {new (completions())
+                    read_some_v_completion{this, fd, bufs, timeout, loc}};
+}
+#else
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_read_some_v(
+        socket_descriptor fd,
+        std::span<std::span<std::byte> const> bufs,
+        std::optional<std::chrono::nanoseconds> timeout,
+        felspar::source_location const &loc) {
+    return warden::do_read_some_v(fd, bufs, timeout, loc);
+}
+#endif
+
+
+/**
+ * The buffer is only taken from the pool once the read can go ahead. If there
+ * are none free the IOP waits for the file descriptor to become readable so
+ * that an idle connection doesn't fail just because the pool is busy.
+ */
+struct felspar::io::poll_warden::read_pooled_completion :
+public completion<buffer_lease> {
+    read_pooled_completion(
+            poll_warden *s,
+            socket_descriptor f,
+            buffer_pool &p,
+            std::optional<std::chrono::nanoseconds> timeout,
+            felspar::source_location const &loc)
+    : completion<buffer_lease>{s, timeout, loc}, fd{f}, pool{p} {}
+    socket_descriptor fd;
+    buffer_pool &pool;
+    bool waited = false;
+    void cancel_iop() override { self->remove_reader(fd, this); }
+    felspar::coro::coroutine_handle<> try_or_resume() override {
+        auto const id = pool.acquire();
+        if (not id and not waited) {
+            waited = true;
+            self->add_reader(fd, this);
+            return felspar::coro::noop_coroutine();
+        } else if (not id) {
+            pool.exhausted();
+            result = {{ENOBUFS, std::system_category()}, "read_pooled"};
+            return cancel_timeout_then_resume();
+        }
+        auto const buf = pool.buffer(*id);
+#ifdef FELSPAR_WINSOCK2
+        if (auto const bytes = recv(
+                    fd, reinterpret_cast<char *>(buf.data()), buf.size(), {});
+            bytes != SOCKET_ERROR) {
+#else
+        if (auto const bytes = ::read(fd, buf.data(), buf.size()); bytes >= 0) {
+#endif
+            result = pool.lease(*id, bytes);
+            return cancel_timeout_then_resume();
+        } else if (auto const error = get_error(); would_block(error)) {
+            pool.give_back(*id);
+            waited = true;
+            self->add_reader(fd, this);
+            return felspar::coro::noop_coroutine();
+        } else {
+            pool.give_back(*id);
+            result = {{error, std::system_category()}, "read_pooled"};
+            return cancel_timeout_then_resume();
+        }
+    }
+};
+felspar::io::iop<felspar::io::buffer_lease>
+        felspar::io::poll_warden::do_read_pooled(
+                socket_descriptor fd,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &loc) {
+    return {new (completions()) read_pooled_completion{
+            this, fd, read_buffers(), timeout, loc}};
 }
 
 
@@ -98,7 +229,7 @@ public completion<std::size_t> {
     : completion<std::size_t>{s, t, loc}, fd{f}, buf{b} {}
     socket_descriptor fd;
     std::span<std::byte const> buf;
-    void cancel_iop() override { std::erase(self->requests[fd].writes, this); }
+    void cancel_iop() override { self->remove_writer(fd, this); }
     felspar::coro::coroutine_handle<> try_or_resume() override {
 #ifdef FELSPAR_WINSOCK2
         if (auto const bytes =
@@ -112,7 +243,7 @@ public completion<std::size_t> {
             result = bytes;
             return cancel_timeout_then_resume();
         } else if (auto const error = get_error(); would_block(error)) {
-            self->requests[fd].writes.push_back(this);
+            self->add_writer(fd, this);
             return felspar::coro::noop_coroutine();
         } else {
             result = {{error, std::system_category()}, "write"};
@@ -125,8 +256,442 @@ felspar::io::iop<std::size_t> felspar::io::poll_warden::do_write_some(
         std::span<std::byte const> buf,
         std::optional<std::chrono::nanoseconds> t,
         felspar::source_location const &loc) {
-    return {new write_some_completion{this, fd, buf, t, loc}};
+    return {new (completions()) write_some_completion{this, fd, buf, t, loc}};
+}
+
+
+#if not defined(FELSPAR_WINSOCK2)
+struct felspar::io::poll_warden::write_some_v_completion :
+public completion<std::size_t> {
+    write_some_v_completion(
+            poll_warden *s,
+            socket_descriptor f,
+            std::span<std::span<std::byte const> const> b,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc}, fd{f}, iovecs{iovecs_for(b)} {}
+    socket_descriptor fd;
+    std::vector<::iovec> iovecs;
+    void cancel_iop() override { self->remove_writer(fd, this); }
+    felspar::coro::coroutine_handle<> try_or_resume() override {
+        if (auto const bytes = ::writev(fd, iovecs.data(), iovecs.size());
+            bytes >= 0) {
+            result = bytes;
+            return cancel_timeout_then_resume();
+        } else if (auto const error = get_error(); would_block(error)) {
+            self->add_writer(fd, this);
+            return felspar::coro::noop_coroutine();
+        } else {
+            result = {{error, std::system_category()}, "writev"};
+            return cancel_timeout_then_resume();
+        }
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_write_some_v(
+        socket_descriptor fd,
+        std::span<std::span<std::byte const> const> bufs,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return {new (completions())
+                    write_some_v_completion{this, fd, bufs, t, loc}};
+}
+#else
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_write_some_v(
+        socket_descriptor fd,
+        std::span<std::span<std::byte const> const> bufs,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return warden::do_write_some_v(fd, bufs, t, loc);
+}
+#endif
+
+
+#if defined(MSG_ZEROCOPY) and defined(SO_EE_ORIGIN_ZEROCOPY)
+/**
+ * The send is made with `MSG_ZEROCOPY` and the IOP then waits on the socket's
+ * error queue for the notification that the kernel has released the pages.
+ * The notification makes the socket report an error, which wakes readers.
+ */
+struct felspar::io::poll_warden::send_zc_completion :
+public completion<std::size_t> {
+    send_zc_completion(
+            poll_warden *s,
+            socket_descriptor f,
+            std::span<std::byte const> b,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc}, fd{f}, buf{b} {}
+    socket_descriptor fd;
+    std::span<std::byte const> buf;
+    bool sent = false, zerocopy = true;
+    void cancel_iop() override {
+        if (sent) {
+            self->remove_reader(fd, this);
+        } else {
+            self->remove_writer(fd, this);
+        }
+    }
+    felspar::coro::coroutine_handle<> try_or_resume() override {
+        if (sent) { return released(); }
+        if (zerocopy and not buf.empty()) {
+            /// Without the option the kernel ignores `MSG_ZEROCOPY`, and there
+            /// will never be a notification to wait for
+            int const on = 1;
+            zerocopy = ::setsockopt(
+                               fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on))
+                    == 0;
+        }
+        int const flags = zerocopy and not buf.empty() ? MSG_ZEROCOPY : 0;
+        if (auto const bytes = ::send(fd, buf.data(), buf.size(), flags);
+            bytes >= 0) {
+            result = bytes;
+            if (not flags) { return cancel_timeout_then_resume(); }
+            sent = true;
+            cancel_timeout();
+            return released();
+        } else if (auto const error = get_error(); would_block(error)) {
+            self->add_writer(fd, this);
+            return felspar::coro::noop_coroutine();
+        } else if (error == ENOBUFS and zerocopy) {
+            /// The socket's option memory limit is used up, so copy instead
+            zerocopy = false;
+            return try_or_resume();
+        } else {
+            result = {{error, std::system_category()}, "send_zc"};
+            return cancel_timeout_then_resume();
+        }
+    }
+    felspar::coro::coroutine_handle<> released() {
+        std::array<char, 128> control;
+        while (true) {
+            ::msghdr msg{};
+            msg.msg_control = control.data();
+            msg.msg_controllen = control.size();
+            if (::recvmsg(fd, &msg, MSG_ERRQUEUE) < 0) {
+                if (auto const error = get_error(); would_block(error)) {
+                    self->add_reader(fd, this);
+                    return felspar::coro::noop_coroutine();
+                } else {
+                    result = {{error, std::system_category()}, "send_zc"};
+                    return handle;
+                }
+            }
+            for (auto *cm = CMSG_FIRSTHDR(&msg); cm;
+                 cm = CMSG_NXTHDR(&msg, cm)) {
+                auto const *const ee =
+                        reinterpret_cast<::sock_extended_err const *>(
+                                CMSG_DATA(cm));
+                if (ee->ee_origin == SO_EE_ORIGIN_ZEROCOPY) { return handle; }
+            }
+        }
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_send_zc(
+        socket_descriptor fd,
+        std::span<std::byte const> buf,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return {new (completions()) send_zc_completion{this, fd, buf, t, loc}};
 }
+#else
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_send_zc(
+        socket_descriptor fd,
+        std::span<std::byte const> buf,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return do_write_some(fd, buf, t, loc);
+}
+#endif
+
+
+struct felspar::io::poll_warden::send_file_completion :
+public completion<std::size_t> {
+    send_file_completion(
+            poll_warden *s,
+            socket_descriptor sk,
+            socket_descriptor f,
+            std::uint64_t const o,
+            std::size_t const l,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc},
+      sock{sk},
+      file{f},
+      offset{o},
+      length{l} {}
+    socket_descriptor sock, file;
+    std::uint64_t offset;
+    std::size_t length;
+    void cancel_iop() override { self->remove_writer(sock, this); }
+    felspar::coro::coroutine_handle<> try_or_resume() override {
+#if __has_include(<sys/sendfile.h>)
+        auto position = static_cast<::off_t>(offset);
+        if (auto const bytes = ::sendfile(sock, file, &position, length);
+            bytes >= 0) {
+            result = bytes;
+            return cancel_timeout_then_resume();
+        } else if (auto const error = get_error(); would_block(error)) {
+            self->add_writer(sock, this);
+            return felspar::coro::noop_coroutine();
+        } else {
+            result = {{error, std::system_category()}, "sendfile"};
+            return cancel_timeout_then_resume();
+        }
+#else
+        result = {
+                std::make_error_code(std::errc::operation_not_supported),
+                "send_file_some needs sendfile"};
+        return cancel_timeout_then_resume();
+#endif
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_send_file_some(
+        socket_descriptor sock,
+        socket_descriptor file,
+        std::uint64_t offset,
+        std::size_t length,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return {new (completions()) send_file_completion{
+            this, sock, file, offset, length, t, loc}};
+}
+
+
+#if not defined(FELSPAR_WINSOCK2)
+/**
+ * File IOPs make their system call on an offload thread, which also fills in
+ * the result. The offload pool's mutex makes sure that is seen by the warden's
+ * thread before the IOP is resumed.
+ */
+template<typename R>
+struct felspar::io::poll_warden::file_completion :
+public completion<R>,
+        public offloaded {
+    file_completion(poll_warden *s, felspar::source_location const &loc)
+    : completion<R>{s, {}, loc} {}
+    void cancel_iop() override {}
+    felspar::coro::coroutine_handle<> try_or_resume() override {
+        this->self->offloader().submit(this);
+        return felspar::coro::noop_coroutine();
+    }
+    felspar::coro::coroutine_handle<> finish() override {
+        return this->cancel_timeout_then_resume();
+    }
+    bool delete_due_to_iop_destructed() override {
+        return not submitted or this->self->offloader().withdraw(this);
+    }
+};
+
+
+struct felspar::io::poll_warden::read_at_completion :
+public file_completion<std::size_t> {
+    read_at_completion(
+            poll_warden *s,
+            socket_descriptor f,
+            std::span<std::byte> b,
+            std::uint64_t const o,
+            felspar::source_location const &loc)
+    : file_completion<std::size_t>{s, loc}, fd{f}, buf{b}, offset{o} {}
+    socket_descriptor fd;
+    std::span<std::byte> buf;
+    std::uint64_t offset;
+    void run() noexcept override {
+        if (auto const bytes = ::pread(
+                    fd, buf.data(), buf.size(), static_cast<::off_t>(offset));
+            bytes >= 0) {
+            result = static_cast<std::size_t>(bytes);
+        } else {
+            result = {{errno, std::system_category()}, "pread"};
+        }
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_read_at(
+        socket_descriptor fd,
+        std::span<std::byte> buf,
+        std::uint64_t offset,
+        felspar::source_location const &loc) {
+    return {new (completions())
+                    read_at_completion{this, fd, buf, offset, loc}};
+}
+
+
+struct felspar::io::poll_warden::write_at_completion :
+public file_completion<std::size_t> {
+    write_at_completion(
+            poll_warden *s,
+            socket_descriptor f,
+            std::span<std::byte const> b,
+            std::uint64_t const o,
+            felspar::source_location const &loc)
+    : file_completion<std::size_t>{s, loc}, fd{f}, buf{b}, offset{o} {}
+    socket_descriptor fd;
+    std::span<std::byte const> buf;
+    std::uint64_t offset;
+    void run() noexcept override {
+        if (auto const bytes = ::pwrite(
+                    fd, buf.data(), buf.size(), static_cast<::off_t>(offset));
+            bytes >= 0) {
+            result = static_cast<std::size_t>(bytes);
+        } else {
+            result = {{errno, std::system_category()}, "pwrite"};
+        }
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_write_at(
+        socket_descriptor fd,
+        std::span<std::byte const> buf,
+        std::uint64_t offset,
+        felspar::source_location const &loc) {
+    return {new (completions())
+                    write_at_completion{this, fd, buf, offset, loc}};
+}
+
+
+struct felspar::io::poll_warden::open_completion :
+public file_completion<socket_descriptor> {
+    open_completion(
+            poll_warden *s,
+            char const *p,
+            int const f,
+            int const m,
+            felspar::source_location const &loc)
+    : file_completion<socket_descriptor>{s, loc},
+      path{p},
+      flags{f},
+      mode{m} {}
+    std::string path;
+    int flags, mode;
+    void run() noexcept override {
+        if (auto const fd = ::open(path.c_str(), flags | O_CLOEXEC, mode);
+            fd >= 0) {
+            result = fd;
+        } else {
+            result = {{errno, std::system_category()}, "open"};
+        }
+    }
+};
+felspar::io::iop<felspar::io::socket_descriptor>
+        felspar::io::poll_warden::do_open(
+                char const *path,
+                int flags,
+                int mode,
+                felspar::source_location const &loc) {
+    return {new (completions()) open_completion{this, path, flags, mode, loc}};
+}
+
+
+struct felspar::io::poll_warden::fsync_completion :
+public file_completion<void> {
+    fsync_completion(
+            poll_warden *s,
+            socket_descriptor f,
+            bool const d,
+            felspar::source_location const &loc)
+    : file_completion<void>{s, loc}, fd{f}, data_only{d} {}
+    socket_descriptor fd;
+    bool data_only;
+    void run() noexcept override {
+#if defined(__APPLE__)
+        /// macOS has no `fdatasync`
+        if (::fsync(fd) != 0) {
+#else
+        if ((data_only ? ::fdatasync(fd) : ::fsync(fd)) != 0) {
+#endif
+            result = {
+                    {errno, std::system_category()},
+                    data_only ? "fdatasync" : "fsync"};
+        }
+    }
+};
+felspar::io::iop<void> felspar::io::poll_warden::do_fsync(
+        socket_descriptor fd,
+        bool data_only,
+        felspar::source_location const &loc) {
+    return {new (completions()) fsync_completion{this, fd, data_only, loc}};
+}
+
+
+struct felspar::io::poll_warden::stat_completion :
+public file_completion<file_status> {
+    stat_completion(
+            poll_warden *s,
+            socket_descriptor f,
+            char const *p,
+            felspar::source_location const &loc)
+    : file_completion<file_status>{s, loc},
+      fd{f},
+      by_fd{p == nullptr},
+      path{p ? p : ""} {}
+    socket_descriptor fd;
+    bool by_fd;
+    std::string path;
+    void run() noexcept override {
+        struct ::stat st;
+        if ((by_fd ? ::fstat(fd, &st) : ::stat(path.c_str(), &st)) == 0) {
+#if defined(__APPLE__)
+            auto const &mtime = st.st_mtimespec;
+#else
+            auto const &mtime = st.st_mtim;
+#endif
+            result = file_status{
+                    .size = static_cast<std::uint64_t>(st.st_size),
+                    .mode = static_cast<std::uint32_t>(st.st_mode),
+                    .links = static_cast<std::uint32_t>(st.st_nlink),
+                    .inode = static_cast<std::uint64_t>(st.st_ino),
+                    .modified = std::chrono::system_clock::time_point{
+                            std::chrono::duration_cast<
+                                    std::chrono::system_clock::duration>(
+                                    std::chrono::seconds{mtime.tv_sec}
+                                    + std::chrono::nanoseconds{
+                                            mtime.tv_nsec})}};
+        } else {
+            result = {
+                    {errno, std::system_category()}, by_fd ? "fstat" : "stat"};
+        }
+    }
+};
+felspar::io::iop<felspar::io::file_status> felspar::io::poll_warden::do_stat(
+        socket_descriptor fd,
+        char const *path,
+        felspar::source_location const &loc) {
+    return {new (completions()) stat_completion{this, fd, path, loc}};
+}
+#else
+namespace {
+    [[noreturn]] void no_file_iops(felspar::source_location const &loc) {
+        throw felspar::stdexcept::system_error{
+                std::make_error_code(std::errc::operation_not_supported),
+                "File IOPs are not supported on Windows", loc};
+    }
+}
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_read_at(
+        socket_descriptor,
+        std::span<std::byte>,
+        std::uint64_t,
+        felspar::source_location const &loc) {
+    no_file_iops(loc);
+}
+felspar::io::iop<std::size_t> felspar::io::poll_warden::do_write_at(
+        socket_descriptor,
+        std::span<std::byte const>,
+        std::uint64_t,
+        felspar::source_location const &loc) {
+    no_file_iops(loc);
+}
+felspar::io::iop<felspar::io::socket_descriptor>
+        felspar::io::poll_warden::do_open(
+                char const *, int, int, felspar::source_location const &loc) {
+    no_file_iops(loc);
+}
+felspar::io::iop<void> felspar::io::poll_warden::do_fsync(
+        socket_descriptor, bool, felspar::source_location const &loc) {
+    no_file_iops(loc);
+}
+felspar::io::iop<felspar::io::file_status> felspar::io::poll_warden::do_stat(
+        socket_descriptor, char const *, felspar::source_location const &loc) {
+    no_file_iops(loc);
+}
+#endif
 
 
 struct felspar::io::poll_warden::accept_completion :
@@ -138,7 +703,7 @@ public completion<socket_descriptor> {
             felspar::source_location const &loc)
     : completion<socket_descriptor>{s, t, loc}, fd{f} {}
     socket_descriptor fd;
-    void cancel_iop() override { std::erase(self->requests[fd].reads, this); }
+    void cancel_iop() override { self->remove_reader(fd, this); }
     felspar::coro::coroutine_handle<> try_or_resume() override {
 #ifdef FELSPAR_WINSOCK2
         if (auto const r = ::accept(fd, nullptr, nullptr);
@@ -153,7 +718,7 @@ public completion<socket_descriptor> {
             result = r;
             return cancel_timeout_then_resume();
         } else if (auto const error = get_error(); would_block(error)) {
-            self->requests[fd].reads.push_back(this);
+            self->add_reader(fd, this);
             return felspar::coro::noop_coroutine();
         } else if (bad_fd(error)) {
             result = r;
@@ -169,7 +734,7 @@ felspar::io::iop<felspar::io::socket_descriptor>
                 socket_descriptor fd,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &loc) {
-    return {new accept_completion{this, fd, timeout, loc}};
+    return {new (completions()) accept_completion{this, fd, timeout, loc}};
 }
 
 
@@ -185,7 +750,7 @@ struct felspar::io::poll_warden::connect_completion : public completion<void> {
     socket_descriptor fd;
     sockaddr const *addr;
     socklen_t addrlen;
-    void cancel_iop() override { std::erase(self->requests[fd].writes, this); }
+    void cancel_iop() override { self->remove_writer(fd, this); }
     felspar::coro::coroutine_handle<>
             await_suspend(felspar::coro::coroutine_handle<> h) override {
         handle = h;
@@ -193,7 +758,7 @@ struct felspar::io::poll_warden::connect_completion : public completion<void> {
         if (auto err = ::connect(fd, addr, addrlen); err != SOCKET_ERROR) {
             return handle;
         } else if (auto const wsae = WSAGetLastError(); would_block(wsae)) {
-            self->requests[fd].writes.push_back(this);
+            self->add_writer(fd, this);
             insert_timeout();
             return felspar::coro::noop_coroutine();
         } else {
@@ -204,7 +769,7 @@ struct felspar::io::poll_warden::connect_completion : public completion<void> {
         if (auto err = ::connect(fd, addr, addrlen); err == 0) {
             return handle;
         } else if (errno == EINPROGRESS) {
-            self->requests[fd].writes.push_back(this);
+            self->add_writer(fd, this);
             insert_timeout();
             return felspar::coro::noop_coroutine();
         } else {
@@ -227,7 +792,7 @@ struct felspar::io::poll_warden::connect_completion : public completion<void> {
             if (errvalue == 0) {
                 return cancel_timeout_then_resume();
             } else if (errno == EINPROGRESS) {
-                self->requests[fd].writes.push_back(this);
+                self->add_writer(fd, this);
                 insert_timeout();
                 return felspar::coro::noop_coroutine();
             } else {
@@ -250,7 +815,8 @@ felspar::io::iop<void> felspar::io::poll_warden::do_connect(
         socklen_t addrlen,
         std::optional<std::chrono::nanoseconds> timeout,
         felspar::source_location const &loc) {
-    return {new connect_completion{this, fd, addr, addrlen, timeout, loc}};
+    return {new (completions())
+                    connect_completion{this, fd, addr, addrlen, timeout, loc}};
 }
 
 
@@ -263,11 +829,11 @@ public completion<void> {
             felspar::source_location const &loc)
     : completion<void>{s, t, loc}, fd{f} {}
     socket_descriptor fd;
-    void cancel_iop() override { std::erase(self->requests[fd].reads, this); }
+    void cancel_iop() override { self->remove_reader(fd, this); }
     felspar::coro::coroutine_handle<>
             await_suspend(felspar::coro::coroutine_handle<> h) override {
         handle = h;
-        self->requests[fd].reads.push_back(this);
+        self->add_reader(fd, this);
         insert_timeout();
         return felspar::coro::noop_coroutine();
     }
@@ -279,7 +845,7 @@ felspar::io::iop<void> felspar::io::poll_warden::do_read_ready(
         socket_descriptor fd,
         std::optional<std::chrono::nanoseconds> timeout,
         felspar::source_location const &loc) {
-    return {new read_ready_completion{this, fd, timeout, loc}};
+    return {new (completions()) read_ready_completion{this, fd, timeout, loc}};
 }
 
 
@@ -292,11 +858,11 @@ public completion<void> {
             felspar::source_location const &loc)
     : completion<void>{s, t, loc}, fd{f} {}
     socket_descriptor fd;
-    void cancel_iop() override { std::erase(self->requests[fd].writes, this); }
+    void cancel_iop() override { self->remove_writer(fd, this); }
     felspar::coro::coroutine_handle<> await_suspend(
             felspar::coro::coroutine_handle<> h) noexcept override {
         handle = h;
-        self->requests[fd].writes.push_back(this);
+        self->add_writer(fd, this);
         insert_timeout();
         return felspar::coro::noop_coroutine();
     }
@@ -308,5 +874,5 @@ felspar::io::iop<void> felspar::io::poll_warden::do_write_ready(
         socket_descriptor fd,
         std::optional<std::chrono::nanoseconds> timeout,
         felspar::source_location const &loc) {
-    return {new write_ready_completion{this, fd, timeout, loc}};
+    return {new (completions()) write_ready_completion{this, fd, timeout, loc}};
 }
@@ -0,0 +1,89 @@
+#include "poll.hpp"
+
+#include <algorithm>
+
+
+felspar::io::poll_warden::offload_pool::offload_pool(
+        poll_warden &w, std::size_t const most)
+: ward{w}, most_threads{std::max<std::size_t>(most, 1)} {}
+
+
+felspar::io::poll_warden::offload_pool::~offload_pool() {
+    {
+        std::scoped_lock lock{mutex};
+        stopping = true;
+    }
+    signal.notify_all();
+    for (auto &t : threads) { t.join(); }
+}
+
+
+void felspar::io::poll_warden::offload_pool::submit(offloaded *const job) {
+    job->submitted = true;
+    {
+        std::scoped_lock lock{mutex};
+        job->state = offloaded::stage::queued;
+        queued.push_back(job);
+        /// Threads are only started when there is more work than idle threads
+        if (queued.size() > idle and threads.size() < most_threads) {
+            threads.emplace_back([this]() { work(); });
+        }
+    }
+    signal.notify_one();
+}
+
+
+bool felspar::io::poll_warden::offload_pool::withdraw(offloaded *const job) {
+    std::scoped_lock lock{mutex};
+    if (job->state == offloaded::stage::queued) {
+        std::erase(queued, job);
+        job->submitted = false;
+        return true;
+    } else {
+        job->abandoned = true;
+        return false;
+    }
+}
+
+
+void felspar::io::poll_warden::offload_pool::work() {
+    std::unique_lock lock{mutex};
+    while (true) {
+        ++idle;
+        signal.wait(lock, [this]() { return stopping or not queued.empty(); });
+        --idle;
+        if (stopping) { return; }
+        auto *const job = queued.front();
+        queued.pop_front();
+        job->state = offloaded::stage::running;
+        lock.unlock();
+        job->run();
+        lock.lock();
+        job->state = offloaded::stage::finished;
+        finished.push_back(job);
+        /// If there was already something finished it has been posted
+        if (finished.size() == 1) {
+            lock.unlock();
+            ward.post([this]() { resume_finished(); });
+            lock.lock();
+        }
+    }
+}
+
+
+void felspar::io::poll_warden::offload_pool::resume_finished() {
+    {
+        std::scoped_lock lock{mutex};
+        resuming.swap(finished);
+    }
+    /// Resuming an IOP may start more work, which is added to `finished`
+    for (auto *const job : resuming) {
+        job->submitted = false;
+        if (job->abandoned) {
+            delete job;
+        } else {
+            job->finish().resume();
+        }
+    }
+    resuming.clear();
+}
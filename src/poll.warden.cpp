@@ -1,8 +1,10 @@
 #include "poll.hpp"
+#include "wakeup.hpp"
 
 #include <felspar/exceptions.hpp>
 #include <felspar/io/posix.hpp>
 
+#include <algorithm>
 #include <thread>
 
 #if __has_include(<poll.h>)
@@ -14,24 +16,68 @@
 
 
 struct felspar::io::poll_warden::loop_data {
+    loop_data(poll_warden &w) : wake{w}, watcher{w} {}
+
+    /// Kept up to date by `interest_changed` as IOPs start and stop waiting
 #if defined(FELSPAR_WINSOCK2)
     std::vector<::WSAPOLLFD> iops;
 #else
     std::vector<::pollfd> iops;
 #endif
     std::vector<retrier *> continuations;
+
+    /// The loop's clock, read once per iteration
+    timer_wheel::time_point now = timer_wheel::clock::now();
+    timer_wheel timeouts{now};
+
+    recycler completions;
+
+    /// Other threads use this to wake the loop for posted functions
+    wakeup wake;
+    struct wake_watcher final : public retrier {
+        wake_watcher(poll_warden &w) : ward{w} {}
+        poll_warden &ward;
+        felspar::coro::coroutine_handle<> try_or_resume() override {
+            ward.bookkeeping->wake.drain();
+            ward.add_reader(ward.bookkeeping->wake.native_handle(), this);
+            ward.run_posted();
+            return felspar::coro::noop_coroutine();
+        }
+        felspar::coro::coroutine_handle<> iop_timedout() override {
+            return felspar::coro::noop_coroutine();
+        }
+        /// Stays watching even if `cancel_all` is used on the wake up
+        felspar::coro::coroutine_handle<> iop_cancelled() override {
+            return felspar::coro::noop_coroutine();
+        }
+    } watcher;
+    bool watching = false;
+
+    /// Declared last so that the offload threads stop first
+    std::unique_ptr<offload_pool> blocking;
 };
 
 
-felspar::io::poll_warden::poll_warden()
-: bookkeeping{std::make_unique<loop_data>()} {
+namespace {
+    void startup() {
 #if defined(FELSPAR_WINSOCK2)
-    WORD vreq = MAKEWORD(2, 0);
-    WSADATA sadat;
-    WSAStartup(vreq, &sadat);
+        WORD vreq = MAKEWORD(2, 0);
+        WSADATA sadat;
+        WSAStartup(vreq, &sadat);
 #else
-    ::signal(SIGPIPE, SIG_IGN);
+        ::signal(SIGPIPE, SIG_IGN);
 #endif
+    }
+}
+
+
+felspar::io::poll_warden::poll_warden()
+: bookkeeping{std::make_unique<loop_data>(*this)} {
+    startup();
+}
+felspar::io::poll_warden::poll_warden(frame_pool::options const &o)
+: warden{o}, bookkeeping{std::make_unique<loop_data>(*this)} {
+    startup();
 }
 
 
@@ -43,41 +89,101 @@ felspar::io::poll_warden::~poll_warden() {
 
 
 void felspar::io::poll_warden::run_until(felspar::coro::coroutine_handle<> coro) {
+    watch_wakeups();
+    bookkeeping->now = timer_wheel::clock::now();
     coro.resume();
     while (true) {
-        auto const timeout = clear_timeouts();
+        auto const deadline = clear_timeouts();
         if (coro.done()) { return; }
-        do_poll(timeout);
+        poll_and_resume(deadline);
     }
 }
 
 
 void felspar::io::poll_warden::run_batch() {
+    watch_wakeups();
+    bookkeeping->now = timer_wheel::clock::now();
     clear_timeouts();
-    do_poll(0);
+    poll_and_resume(bookkeeping->now);
 }
 
 
-void felspar::io::poll_warden::do_poll(int const timeout) {
-    bookkeeping->iops.clear();
-    for (auto const &req : requests) {
-        short flags = {};
-        if (not req.second.reads.empty()) { flags |= POLLIN; }
-        if (not req.second.writes.empty()) { flags |= POLLOUT; }
-        bookkeeping->iops.push_back({req.first, flags, {}});
-#if defined(FELSPAR_WINSOCK2)
-        if (bookkeeping->iops.size() == std::numeric_limits<ULONG>::max()) {
-            break;
-        }
-#endif
+felspar::io::recycler &felspar::io::poll_warden::completions() noexcept {
+    return bookkeeping->completions;
+}
+
+
+/**
+ * The wake up can't be watched from the constructor because a sub-class may
+ * need to know about it through `interest_changed`
+ */
+void felspar::io::poll_warden::watch_wakeups() {
+    if (not std::exchange(bookkeeping->watching, true)) {
+        add_reader(bookkeeping->wake.native_handle(), &bookkeeping->watcher);
+    }
+}
+void felspar::io::poll_warden::do_wake() noexcept {
+    bookkeeping->wake.signal();
+}
+
+
+auto felspar::io::poll_warden::offloader() -> offload_pool & {
+    if (not bookkeeping->blocking) {
+        bookkeeping->blocking =
+                std::make_unique<offload_pool>(*this, offload_threads);
+    }
+    return *bookkeeping->blocking;
+}
+void felspar::io::poll_warden::submit_offloaded(offloaded *const job) {
+    offloader().submit(job);
+}
+void felspar::io::poll_warden::abandon_offloaded(offloaded *const job) {
+    if (not job->submitted or offloader().withdraw(job)) { delete job; }
+}
+
+
+auto felspar::io::poll_warden::loop_time() const noexcept -> time_point {
+    return bookkeeping->now;
+}
+
+
+void felspar::io::poll_warden::poll_and_resume(
+        std::optional<time_point> const deadline) {
+    auto &continuations = bookkeeping->continuations;
+    continuations.clear();
+    ++loop_stats.waits;
+    do_poll(deadline, continuations);
+    bookkeeping->now = timer_wheel::clock::now();
+    for (auto continuation : continuations) {
+        /// Cancelled IOPs are removed from the list while it is being resumed
+        if (continuation) { continuation->try_or_resume().resume(); }
     }
+}
+
 
+void felspar::io::poll_warden::do_poll(
+        std::optional<time_point> const deadline,
+        std::vector<retrier *> &continuations) {
+    auto &iops = bookkeeping->iops;
+    std::optional<std::chrono::nanoseconds> wait;
+    if (deadline) {
+        wait = std::max(
+                *deadline - bookkeeping->now, std::chrono::nanoseconds{});
+    }
+#if not defined(FELSPAR_HAS_PPOLL)
+    /// Round up so that the wait never ends before the deadline
+    int timeout = -1;
+    if (wait) {
+        timeout = static_cast<int>(std::min<std::chrono::milliseconds::rep>(
+                std::numeric_limits<int>::max(),
+                std::chrono::ceil<std::chrono::milliseconds>(*wait).count()));
+    }
+#endif
     int const pr = [&]() {
-        if (bookkeeping->iops.size()) {
 #if defined(FELSPAR_WINSOCK2)
+        if (iops.size()) {
             int response = ::WSAPoll(
-                    bookkeeping->iops.data(),
-                    static_cast<ULONG>(bookkeeping->iops.size()), timeout);
+                    iops.data(), static_cast<ULONG>(iops.size()), timeout);
             if (response < 0) {
                 /**
                  * Windows seems to return errors here for no good reason, but
@@ -94,58 +200,157 @@ void felspar::io::poll_warden::do_poll(int const timeout) {
             } else {
                 return response;
             }
-#else
-            return ::poll(
-                    bookkeeping->iops.data(), bookkeeping->iops.size(),
-                    timeout);
-#endif
         } else {
+            /// `WSAPoll` won't wait on an empty set
             std::this_thread::sleep_for(std::chrono::milliseconds{timeout});
             return 0;
         }
+#elif defined(FELSPAR_HAS_PPOLL)
+        if (wait) {
+            auto const seconds =
+                    std::chrono::duration_cast<std::chrono::seconds>(*wait);
+            ::timespec const ts{
+                    static_cast<::time_t>(seconds.count()),
+                    static_cast<long>((*wait - seconds).count())};
+            return ::ppoll(iops.data(), iops.size(), &ts, nullptr);
+        } else {
+            return ::ppoll(iops.data(), iops.size(), nullptr, nullptr);
+        }
+#else
+        return ::poll(iops.data(), iops.size(), timeout);
+#endif
     }();
     if (pr < 0) {
         throw felspar::stdexcept::system_error{
                 get_error(), std::system_category(), "poll"};
     } else if (pr > 0) {
-        bookkeeping->continuations.clear();
-        for (auto events : bookkeeping->iops) {
-            if (events.revents & (POLLIN | POLLERR | POLLNVAL)) {
-                auto &reads = requests[events.fd].reads;
-                bookkeeping->continuations.insert(
-                        bookkeeping->continuations.end(), reads.begin(),
-                        reads.end());
-                reads.clear();
+        /**
+         * Only the first IOP waiting in each direction is woken. If there are
+         * others then `poll` will report the file descriptor as ready again
+         * next time around if it still is.
+         *
+         * Taking an IOP out may remove the file descriptor from `iops` by
+         * moving the last entry into its place, so walk backwards to make sure
+         * that every entry is only looked at once.
+         */
+        for (std::size_t index = iops.size(); index-- > 0;) {
+            auto const events = iops[index];
+            auto &req = request_for(events.fd);
+            bool changed = false;
+            if (events.revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL)
+                and not req.reads.empty()) {
+                continuations.push_back(req.reads.front());
+                req.reads.erase(req.reads.begin());
+                changed = true;
             }
-            if (events.revents & (POLLOUT | POLLERR | POLLNVAL)) {
-                auto &writes = requests[events.fd].writes;
-                bookkeeping->continuations.insert(
-                        bookkeeping->continuations.end(), writes.begin(),
-                        writes.end());
-                writes.clear();
+            if (events.revents & (POLLOUT | POLLERR | POLLHUP | POLLNVAL)
+                and not req.writes.empty()) {
+                continuations.push_back(req.writes.front());
+                req.writes.erase(req.writes.begin());
+                changed = true;
             }
-        }
-        for (auto continuation : bookkeeping->continuations) {
-            continuation->try_or_resume().resume();
+            if (changed) { interest_changed(events.fd, req); }
         }
     }
 }
 
 
-int felspar::io::poll_warden::clear_timeouts() {
-    while (timeouts.begin() != timeouts.end()) {
-        auto const tdiff =
-                timeouts.begin()->first - std::chrono::steady_clock::now();
-        if (tdiff < std::chrono::milliseconds{1}) {
-            retrier *const retry = timeouts.begin()->second;
-            timeouts.erase(timeouts.begin());
-            retry->iop_timedout().resume();
-        } else {
-            return std::chrono::duration_cast<std::chrono::milliseconds>(tdiff)
-                    .count();
+auto felspar::io::poll_warden::request_for(socket_descriptor const fd)
+        -> request & {
+#if defined(FELSPAR_WINSOCK2)
+    /// Winsock sockets are kernel handles, which are multiples of four
+    std::size_t const index = fd / 4;
+#else
+    std::size_t const index = fd;
+#endif
+    if (index >= requests.size()) { requests.resize(index + 1); }
+    return requests[index];
+}
+
+
+void felspar::io::poll_warden::add_reader(
+        socket_descriptor const fd, retrier *const r) {
+    auto &req = request_for(fd);
+    req.reads.push_back(r);
+    interest_changed(fd, req);
+}
+void felspar::io::poll_warden::add_writer(
+        socket_descriptor const fd, retrier *const r) {
+    auto &req = request_for(fd);
+    req.writes.push_back(r);
+    interest_changed(fd, req);
+}
+void felspar::io::poll_warden::remove_reader(
+        socket_descriptor const fd, retrier *const r) {
+    auto &req = request_for(fd);
+    if (std::erase(req.reads, r)) { interest_changed(fd, req); }
+}
+void felspar::io::poll_warden::remove_writer(
+        socket_descriptor const fd, retrier *const r) {
+    auto &req = request_for(fd);
+    if (std::erase(req.writes, r)) { interest_changed(fd, req); }
+}
+
+
+void felspar::io::poll_warden::do_cancel_all(
+        socket_descriptor const fd, felspar::source_location const &) {
+    auto &req = request_for(fd);
+    std::vector<retrier *> cancelled{req.reads};
+    cancelled.insert(cancelled.end(), req.writes.begin(), req.writes.end());
+    /// Every IOP is cancelled before any of them are resumed
+    std::vector<felspar::coro::coroutine_handle<>> resume;
+    for (auto *const r : cancelled) {
+        std::replace(
+                bookkeeping->continuations.begin(),
+                bookkeeping->continuations.end(), r,
+                static_cast<retrier *>(nullptr));
+        resume.push_back(r->iop_cancelled());
+    }
+    for (auto h : resume) { h.resume(); }
+}
+
+
+void felspar::io::poll_warden::interest_changed(
+        socket_descriptor const fd, request &req) {
+    short events = {};
+    if (not req.reads.empty()) { events |= POLLIN; }
+    if (not req.writes.empty()) { events |= POLLOUT; }
+
+    auto &iops = bookkeeping->iops;
+    if (req.pollfd == request::npos) {
+        if (events) {
+            req.pollfd = iops.size();
+            iops.push_back({fd, events, {}});
+        }
+    } else if (events) {
+        iops[req.pollfd].events = events;
+    } else {
+        auto const index = std::exchange(req.pollfd, request::npos);
+        if (index + 1 != iops.size()) {
+            iops[index] = iops.back();
+            request_for(iops[index].fd).pollfd = index;
         }
+        iops.pop_back();
+    }
+}
+
+
+void felspar::io::poll_warden::schedule(
+        retrier *const retry,
+        std::chrono::nanoseconds const timeout,
+        std::chrono::nanoseconds const slack) {
+    bookkeeping->timeouts.schedule(
+            *retry, coalesce(bookkeeping->now + timeout, slack));
+}
+
+
+auto felspar::io::poll_warden::clear_timeouts() -> std::optional<time_point> {
+    auto &timeouts = bookkeeping->timeouts;
+    timeouts.advance(bookkeeping->now);
+    while (auto *const expired = timeouts.next_expired()) {
+        static_cast<retrier *>(expired)->iop_timedout().resume();
     }
-    return -1;
+    return timeouts.next_deadline();
 }
 
 
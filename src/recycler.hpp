@@ -0,0 +1,98 @@
+#pragma once
+
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+namespace felspar::io {
+
+
+    /// ## Completion recycling
+    /**
+     * Every IOP needs a completion to track it while it runs. Rather than
+     * going to the heap each time, freed completions are kept on a free list
+     * for their size and handed out again to the next IOP that needs that
+     * much memory. Once a warden has warmed up its IOPs don't allocate.
+     *
+     * Each block starts with a pointer to the recycler it came from so that
+     * it can be put back on the right free list. A warden is only ever used
+     * from one thread so there is no locking.
+     */
+    class recycler {
+        struct node {
+            node *next;
+        };
+        static constexpr std::size_t header = alignof(std::max_align_t);
+        static constexpr std::size_t granularity = 16, classes = 32;
+        std::array<node *, classes> free = {};
+
+        static std::size_t size_class(std::size_t const bytes) noexcept {
+            return (bytes + granularity - 1) / granularity - 1;
+        }
+
+
+      public:
+        recycler() = default;
+        recycler(recycler const &) = delete;
+        recycler &operator=(recycler const &) = delete;
+        ~recycler() {
+            for (auto *n : free) {
+                while (n) { ::operator delete(std::exchange(n, n->next)); }
+            }
+        }
+
+
+        void *allocate(std::size_t const bytes) {
+            auto const sc = size_class(bytes);
+            void *block = nullptr;
+            if (sc < classes and free[sc]) {
+                block = std::exchange(free[sc], free[sc]->next);
+            } else if (sc < classes) {
+                block = ::operator new(header + (sc + 1) * granularity);
+            } else {
+                block = ::operator new(header + bytes);
+            }
+            *static_cast<recycler **>(block) = this;
+            return static_cast<std::byte *>(block) + header;
+        }
+        static void
+                deallocate(void *const p, std::size_t const bytes) noexcept {
+            void *const block = static_cast<std::byte *>(p) - header;
+            auto *const self = *static_cast<recycler **>(block);
+            if (auto const sc = size_class(bytes); sc < classes) {
+                self->free[sc] = ::new (block) node{self->free[sc]};
+            } else {
+                ::operator delete(block);
+            }
+        }
+        /// Used when the size isn't known, the block goes back to the heap
+        static void release(void *const p) noexcept {
+            ::operator delete(static_cast<std::byte *>(p) - header);
+        }
+    };
+
+
+    /// ### Mix-in for completions that are allocated from a recycler
+    /**
+     * Completions are deleted through a pointer to one of their bases, each
+     * of which has a virtual destructor, so the size passed to the sized
+     * `operator delete` is always that of the whole completion.
+     */
+    struct recyclable {
+        static void *operator new(std::size_t const bytes, recycler &r) {
+            return r.allocate(bytes);
+        }
+        static void operator delete(void *const p, recycler &) noexcept {
+            recycler::release(p);
+        }
+        static void
+                operator delete(void *const p, std::size_t const bytes) noexcept {
+            recycler::deallocate(p, bytes);
+        }
+    };
+
+
+}
@@ -0,0 +1,394 @@
+#include <felspar/io/connect.hpp>
+#include <felspar/io/error.hpp>
+#include <felspar/io/exceptions.hpp>
+#include <felspar/io/read.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#if __has_include(<arpa/inet.h>)
+#include <arpa/inet.h>
+#endif
+
+
+namespace {
+
+
+    constexpr std::uint16_t type_a = 1, type_soa = 6, class_in = 1;
+    constexpr std::uint8_t rcode_nxdomain = 3;
+
+    std::string lower_case(std::string host) {
+        std::transform(host.begin(), host.end(), host.begin(), [](char c) {
+            return (c >= 'A' and c <= 'Z') ? char(c - 'A' + 'a') : c;
+        });
+        return host;
+    }
+
+    std::optional<in_addr> numeric(std::string const &host) {
+        in_addr address{};
+        if (::inet_pton(AF_INET, host.c_str(), &address) == 1) {
+            return address;
+        } else {
+            return {};
+        }
+    }
+
+    /// A whole number of at least one from the settings files
+    std::optional<std::size_t> count(std::string_view const text) {
+        std::size_t value{};
+        auto const [end, error] =
+                std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc{} or end != text.data() + text.size()) {
+            return {};
+        }
+        return std::max<std::size_t>(value, 1);
+    }
+
+
+    /// ### DNS messages
+    void append16(std::vector<std::byte> &b, std::uint16_t const v) {
+        b.push_back(std::byte(v >> 8));
+        b.push_back(std::byte(v & 0xff));
+    }
+    /// A query with recursion desired for the host's A records
+    std::vector<std::byte> build_query(
+            std::uint16_t const id,
+            std::string const &host,
+            felspar::source_location const &loc) {
+        std::vector<std::byte> q;
+        append16(q, id);
+        append16(q, 0x0100);
+        append16(q, 1);
+        for (std::size_t count{}; count < 3; ++count) { append16(q, 0); }
+        std::string_view labels{host};
+        while (not labels.empty()) {
+            auto const dot = labels.find('.');
+            auto const label = labels.substr(0, dot);
+            if (label.empty() or label.size() > 63) {
+                throw felspar::stdexcept::runtime_error{
+                        "Invalid host name: " + host, loc};
+            }
+            q.push_back(std::byte(label.size()));
+            for (char const c : label) { q.push_back(std::byte(c)); }
+            labels.remove_prefix(
+                    dot == std::string_view::npos ? labels.size() : dot + 1);
+        }
+        q.push_back(std::byte{});
+        append16(q, type_a);
+        append16(q, class_in);
+        return q;
+    }
+
+
+    /// Reads fields from a reply. Reading past the end clears `ok`
+    struct message_reader {
+        std::span<std::byte const> message;
+        std::size_t at = {};
+        bool ok = true;
+
+        bool has(std::size_t const bytes) {
+            ok = ok and at + bytes <= message.size();
+            return ok;
+        }
+        std::uint8_t u8() {
+            if (not has(1)) { return {}; }
+            return std::to_integer<std::uint8_t>(message[at++]);
+        }
+        std::uint16_t u16() {
+            std::uint16_t const high = u8();
+            return (high << 8) | u8();
+        }
+        std::uint32_t u32() {
+            std::uint32_t const high = u16();
+            return (high << 16) | u16();
+        }
+        void skip(std::size_t const bytes) {
+            if (has(bytes)) { at += bytes; }
+        }
+        /// Names may end with a pointer to the rest of the name elsewhere
+        void skip_name() {
+            while (ok) {
+                auto const length = u8();
+                if (length == 0) {
+                    return;
+                } else if ((length & 0xc0) == 0xc0) {
+                    u8();
+                    return;
+                } else {
+                    skip(length);
+                }
+            }
+        }
+    };
+
+
+}
+
+
+struct felspar::io::resolver::answer {
+    std::uint8_t rcode = {};
+    bool truncated = false;
+    std::vector<in_addr> addresses;
+    std::optional<std::chrono::seconds> ttl;
+};
+
+
+felspar::io::resolver::resolver() : resolver{options{}} {}
+
+
+felspar::io::resolver::resolver(options o)
+: ids{std::random_device{}()}, settings{std::move(o)} {
+    if (settings.servers.empty()) { read_resolv_conf(); }
+    if (settings.servers.empty()) {
+        /// The same default as the C library's resolver
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_port = htons(53);
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        settings.servers.push_back(local);
+    }
+    read_hosts();
+}
+
+
+auto felspar::io::resolver::for_this_thread() -> resolver & {
+    thread_local resolver r;
+    return r;
+}
+
+
+void felspar::io::resolver::read_resolv_conf() {
+    if (settings.resolv_conf.empty()) { return; }
+    std::ifstream file{settings.resolv_conf};
+    for (std::string line; std::getline(file, line);) {
+        std::istringstream words{line.substr(0, line.find_first_of("#;"))};
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "nameserver") {
+            std::string server;
+            words >> server;
+            if (auto const address = numeric(server); address) {
+                sockaddr_in in{};
+                in.sin_family = AF_INET;
+                in.sin_port = htons(53);
+                in.sin_addr = *address;
+                settings.servers.push_back(in);
+            }
+        } else if (keyword == "options") {
+            /// Values that aren't numbers are ignored, like the C library does
+            for (std::string option; words >> option;) {
+                if (option.starts_with("timeout:")) {
+                    if (auto const seconds = count(option.substr(8))) {
+                        settings.timeout = std::chrono::seconds{*seconds};
+                    }
+                } else if (option.starts_with("attempts:")) {
+                    if (auto const attempts = count(option.substr(9))) {
+                        settings.attempts = *attempts;
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+void felspar::io::resolver::read_hosts() {
+    if (settings.hosts.empty()) { return; }
+    std::ifstream file{settings.hosts};
+    for (std::string line; std::getline(file, line);) {
+        std::istringstream words{line.substr(0, line.find('#'))};
+        std::string first;
+        words >> first;
+        /// Only IPv4 addresses are looked up
+        if (auto const address = numeric(first); address) {
+            for (std::string name; words >> name;) {
+                hosts[lower_case(name)].push_back(*address);
+            }
+        }
+    }
+}
+
+
+auto felspar::io::resolver::resolve(
+        warden &ward, std::string host, felspar::source_location const &loc)
+        -> warden::task<std::vector<in_addr>> {
+    if (auto const address = numeric(host); address) {
+        co_return std::vector{*address};
+    }
+    host = lower_case(std::move(host));
+    if (host.ends_with('.')) { host.pop_back(); }
+    if (auto const found = hosts.find(host); found != hosts.end()) {
+        co_return found->second;
+    }
+
+    if (auto const found = cache.find(host); found != cache.end()) {
+        if (found->second.expires > std::chrono::steady_clock::now()) {
+            ++stats.cache_hits;
+            if (found->second.addresses.empty()) {
+                throw host_not_found{host, loc};
+            }
+            co_return found->second.addresses;
+        } else {
+            cache.erase(found);
+        }
+    }
+
+    std::exception_ptr failed;
+    for (std::size_t attempt{}; attempt < settings.attempts; ++attempt) {
+        for (auto const &server : settings.servers) {
+            std::optional<answer> reply;
+            try {
+                reply = co_await query(ward, server, host, loc);
+            } catch (stdexcept::system_error const &) {
+                failed = std::current_exception();
+            }
+            if (not reply or reply->truncated
+                or (reply->rcode != 0 and reply->rcode != rcode_nxdomain)) {
+                continue;
+            }
+            /// A name with no addresses is cached like one that doesn't exist
+            auto const ttl = std::min<std::chrono::nanoseconds>(
+                    reply->ttl.value_or(
+                            std::chrono::duration_cast<std::chrono::seconds>(
+                                    settings.negative_ttl)),
+                    settings.max_ttl);
+            /// Expired entries are dropped so that the cache can't keep growing
+            auto const now = std::chrono::steady_clock::now();
+            std::erase_if(cache, [now](auto const &cached) {
+                return cached.second.expires <= now;
+            });
+            cache[host] = {reply->addresses, now + ttl};
+            if (reply->addresses.empty()) { throw host_not_found{host, loc}; }
+            co_return std::move(reply->addresses);
+        }
+    }
+    if (failed) {
+        std::rethrow_exception(failed);
+    } else {
+        throw stdexcept::runtime_error{
+                "No name server could answer for " + host, loc};
+    }
+}
+
+
+/**
+ * The query is sent over a connected UDP socket so that only replies from the
+ * server are seen. Replies that don't match the query's ID are ignored.
+ */
+auto felspar::io::resolver::query(
+        warden &ward,
+        sockaddr_in const &server,
+        std::string const &host,
+        felspar::source_location const &loc) -> warden::task<answer> {
+    std::uint16_t const id = ids();
+    auto const message = build_query(id, host, loc);
+
+    auto sock = ward.create_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, loc);
+    co_await ward.connect(
+            sock, reinterpret_cast<sockaddr const *>(&server), sizeof(server),
+            settings.timeout, loc);
+    ++stats.queries;
+    co_await ward.write_some(
+            sock, std::span<std::byte const>{message}, settings.timeout, loc);
+
+    auto const deadline = std::chrono::steady_clock::now() + settings.timeout;
+    std::array<std::byte, 1232> buffer;
+    while (true) {
+        auto const remaining = std::max<std::chrono::nanoseconds>(
+                deadline - std::chrono::steady_clock::now(), {});
+        auto const bytes = co_await ward.read_some(
+                sock, std::span<std::byte>{buffer}, remaining, loc);
+        message_reader reply{std::span{buffer}.first(bytes)};
+        if (reply.u16() != id) { continue; }
+        /// Must be a response to a standard query
+        auto const flags = reply.u16();
+        if (not(flags & 0x8000) or (flags & 0x7800)) { continue; }
+        answer result;
+        result.rcode = flags & 0x000f;
+        /// The whole answer needs TCP, which isn't used, so it has failed
+        result.truncated = flags & 0x0200;
+        if (result.truncated) { co_return result; }
+
+        auto const questions = reply.u16();
+        auto const answers = reply.u16();
+        auto const authorities = reply.u16();
+        reply.skip(2);
+        for (std::size_t index{}; index < questions; ++index) {
+            reply.skip_name();
+            reply.skip(4);
+        }
+        /**
+         * Any CNAME records come before the A records they lead to, so all of
+         * the A records are taken. The answer lasts as long as the shortest
+         * lived record.
+         */
+        auto const shorten = [&](std::uint32_t const seconds) {
+            std::chrono::seconds const s{seconds};
+            result.ttl = result.ttl ? std::min(*result.ttl, s) : s;
+        };
+        for (std::size_t index{}; index < answers; ++index) {
+            reply.skip_name();
+            auto const type = reply.u16();
+            auto const klass = reply.u16();
+            auto const ttl = reply.u32();
+            auto const length = reply.u16();
+            if (type == type_a and klass == class_in and length == 4
+                and reply.has(4)) {
+                in_addr address{};
+                std::memcpy(&address, buffer.data() + reply.at, 4);
+                result.addresses.push_back(address);
+                shorten(ttl);
+            }
+            reply.skip(length);
+        }
+        /// Negative answers last as long as the SOA's minimum, if it has one
+        if (result.addresses.empty()) {
+            for (std::size_t index{}; index < authorities; ++index) {
+                reply.skip_name();
+                auto const type = reply.u16();
+                reply.skip(2);
+                auto const ttl = reply.u32();
+                auto const length = reply.u16();
+                if (type == type_soa and length >= 20 and reply.has(length)) {
+                    message_reader minimum{
+                            reply.message, reply.at + length - 4};
+                    shorten(std::min(ttl, minimum.u32()));
+                }
+                reply.skip(length);
+            }
+        }
+        if (reply.ok) { co_return result; }
+    }
+}
+
+
+auto felspar::io::connect(
+        warden &ward,
+        resolver &names,
+        std::string host,
+        std::uint16_t const port,
+        std::optional<std::chrono::nanoseconds> const timeout,
+        felspar::source_location const &loc) -> warden::task<posix::fd> {
+    auto const addresses = co_await names.resolve(ward, host, loc);
+    std::error_code error;
+    for (auto const &address : addresses) {
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr = address;
+        auto sock = ward.create_tcp_socket(loc);
+        auto const connected = co_await felspar::io::ec{ward.connect(
+                sock, reinterpret_cast<sockaddr const *>(&in), sizeof(in),
+                timeout, loc)};
+        if (connected) {
+            co_return sock;
+        } else {
+            error = connected.error;
+        }
+    }
+    throw stdexcept::system_error{error, "Connecting to " + host, loc};
+}
@@ -0,0 +1,297 @@
+#pragma once
+
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+
+
+namespace felspar::io {
+
+
+    /// ## Coalesce a deadline
+    /**
+     * Moves the deadline later by less than the slack so that it lands on a
+     * multiple of the largest power of two number of nanoseconds that fits in
+     * the slack. Deadlines with similar slack that are close together end up
+     * at the same instant and can be handled by a single wake up.
+     */
+    template<typename Clock>
+    inline std::chrono::time_point<Clock, std::chrono::nanoseconds> coalesce(
+            std::chrono::time_point<Clock, std::chrono::nanoseconds> const
+                    deadline,
+            std::chrono::nanoseconds const slack) noexcept {
+        if (slack.count() <= 0) {
+            return deadline;
+        } else {
+            auto const grain = static_cast<std::chrono::nanoseconds::rep>(
+                    std::bit_floor(static_cast<std::uint64_t>(slack.count())));
+            auto const since = deadline.time_since_epoch().count();
+            return std::chrono::time_point<Clock, std::chrono::nanoseconds>{
+                    std::chrono::nanoseconds{
+                            (since + grain - 1) / grain * grain}};
+        }
+    }
+
+
+    /// ## Hierarchical timer wheel
+    /**
+     * Timers are kept in intrusive lists so that scheduling and cancelling a
+     * timer are both constant time. There are four levels of 64 slots. A slot
+     * at level zero covers a single tick (one millisecond), a slot at level
+     * one covers 64 ticks and so on. A timer is stored at the lowest level
+     * where its tick shares all higher digits with the current tick, and is
+     * moved down a level as the wheel catches up with it. This means a timer
+     * is touched at most once per level before it expires. Anything more than
+     * about four and a half hours out goes into an overflow list that is
+     * looked at whenever the top level wraps around.
+     *
+     * Timers whose tick has been reached, but whose exact deadline hasn't,
+     * are kept in a separate pending list so that no timer ever fires before
+     * its deadline.
+     */
+    class timer_wheel {
+      public:
+        using clock = std::chrono::steady_clock;
+        using time_point = clock::time_point;
+
+
+        /// ### Intrusive list links
+        struct link {
+            link *next = nullptr, *prev = nullptr;
+
+            bool is_linked() const noexcept { return next != nullptr; }
+            void unlink() noexcept {
+                if (next) {
+                    prev->next = next;
+                    next->prev = prev;
+                    next = prev = nullptr;
+                }
+            }
+        };
+        /// ### A timer which is embedded in whatever needs timing
+        struct timer : public link {
+            time_point deadline = {};
+        };
+
+
+        explicit timer_wheel(time_point const now) : now_tick{tick_of(now)} {}
+
+        timer_wheel(timer_wheel const &) = delete;
+        timer_wheel &operator=(timer_wheel const &) = delete;
+
+
+        /// ### Schedule (or re-schedule) the timer
+        void schedule(timer &t, time_point const deadline) {
+            t.unlink();
+            t.deadline = deadline;
+            place(t);
+        }
+        /// ### Cancel the timer if it is scheduled
+        static void cancel(timer &t) noexcept { t.unlink(); }
+
+
+        /// ### Move all timers that are due by `now` into the expired list
+        void advance(time_point const now) {
+            auto const target = tick_of(now);
+            while (now_tick < target) {
+                /// Skip straight past any ticks where there is nothing to do
+                if (auto const next = next_tick(); next > target) {
+                    now_tick = target;
+                    break;
+                } else {
+                    now_tick = std::max(now_tick, next - 1);
+                }
+                /// Level zero slots up to the end of this block or the target
+                if (std::size_t const first = (now_tick & mask) + 1;
+                    first < slots) {
+                    auto const upto = std::min(target, now_tick | mask);
+                    std::uint64_t const range =
+                            (~std::uint64_t{} >> (mask - (upto & mask)))
+                            & (~std::uint64_t{} << first);
+                    for (auto bits = occupied[0] & range; bits;
+                         bits &= bits - 1) {
+                        auto const slot = std::countr_zero(bits);
+                        occupied[0] &= ~(std::uint64_t{1} << slot);
+                        sort(wheel[0][slot], now);
+                    }
+                    now_tick = upto;
+                }
+                if (now_tick < target) {
+                    ++now_tick;
+                    cascade();
+                }
+            }
+            sort(pending, now);
+        }
+
+
+        /// ### Take the next timer that has expired
+        timer *next_expired() noexcept {
+            if (expired.empty()) {
+                return nullptr;
+            } else {
+                auto *t = static_cast<timer *>(expired.head.next);
+                t->unlink();
+                return t;
+            }
+        }
+
+
+        /// ### The time by which the wheel needs to be advanced again
+        /**
+         * This is exact for timers in the pending list and at level zero. For
+         * timers at higher levels it is the start of their slot, which is
+         * when they need to be moved to a lower level.
+         */
+        std::optional<time_point> next_deadline() noexcept {
+            if (auto const next = earliest(pending)) {
+                return next;
+            } else if (auto const tick = next_tick(); tick == never) {
+                return {};
+            } else if (occupied[0]) {
+                return earliest(wheel[0][std::countr_zero(occupied[0])]);
+            } else {
+                return time_point{timer_wheel::tick * tick};
+            }
+        }
+
+
+      private:
+        static constexpr std::size_t levels = 4, bits = 6, slots = 1 << bits;
+        static constexpr std::int64_t mask = slots - 1;
+        static constexpr std::chrono::milliseconds tick{1};
+
+        static std::int64_t tick_of(time_point const tp) noexcept {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                           tp.time_since_epoch())
+                    .count();
+        }
+
+        /// A circular list with a sentinel head
+        struct list {
+            link head;
+            list() { head.next = head.prev = &head; }
+            list(list const &) = delete;
+            list &operator=(list const &) = delete;
+
+            bool empty() const noexcept { return head.next == &head; }
+            void push_back(link &l) noexcept {
+                l.prev = head.prev;
+                l.next = &head;
+                head.prev->next = &l;
+                head.prev = &l;
+            }
+            /// Take all of the links from the other list, this must be empty
+            void take(list &other) noexcept {
+                if (not other.empty()) {
+                    head.next = std::exchange(other.head.next, &other.head);
+                    head.prev = std::exchange(other.head.prev, &other.head);
+                    head.next->prev = &head;
+                    head.prev->next = &head;
+                }
+            }
+        };
+
+        std::int64_t now_tick;
+        std::array<std::array<list, slots>, levels> wheel;
+        std::array<std::uint64_t, levels> occupied = {};
+        list overflow, pending, expired;
+
+
+        static constexpr std::int64_t never =
+                std::numeric_limits<std::int64_t>::max();
+        /**
+         * The first tick at which a slot needs to be looked at. Slots that are
+         * empty because their timers were cancelled are cleared here.
+         */
+        std::int64_t next_tick() noexcept {
+            for (std::size_t level{}; level < levels; ++level) {
+                while (occupied[level]) {
+                    auto const slot = std::countr_zero(occupied[level]);
+                    if (wheel[level][slot].empty()) {
+                        occupied[level] &= ~(std::uint64_t{1} << slot);
+                    } else {
+                        auto const shift = bits * level;
+                        return ((now_tick >> (shift + bits)) << (shift + bits))
+                                | (std::int64_t(slot) << shift);
+                    }
+                }
+            }
+            if (overflow.empty()) {
+                return never;
+            } else {
+                auto const shift = bits * levels;
+                return ((now_tick >> shift) + 1) << shift;
+            }
+        }
+
+        void place(timer &t) noexcept {
+            auto const t_tick = tick_of(t.deadline);
+            if (t_tick <= now_tick) {
+                pending.push_back(t);
+            } else if (std::uint64_t const diff = t_tick ^ now_tick;
+                       diff >> (bits * levels)) {
+                overflow.push_back(t);
+            } else {
+                std::size_t const level = (std::bit_width(diff) - 1) / bits;
+                std::size_t const slot = (t_tick >> (bits * level)) & mask;
+                wheel[level][slot].push_back(t);
+                occupied[level] |= std::uint64_t{1} << slot;
+            }
+        }
+
+        /**
+         * Re-place every timer in the list relative to the current tick. Some
+         * of them may end up back in the same list.
+         */
+        void redistribute(list &from) noexcept {
+            list moving;
+            moving.take(from);
+            while (not moving.empty()) {
+                auto *t = static_cast<timer *>(moving.head.next);
+                t->unlink();
+                place(*t);
+            }
+        }
+        /// Move the higher level slots that the current tick has reached down
+        void cascade() noexcept {
+            for (std::size_t level{1}; level < levels; ++level) {
+                std::size_t const slot = (now_tick >> (bits * level)) & mask;
+                occupied[level] &= ~(std::uint64_t{1} << slot);
+                redistribute(wheel[level][slot]);
+                if (slot) { return; }
+            }
+            redistribute(overflow);
+        }
+        /// Split a list into those timers that have expired and those pending
+        void sort(list &from, time_point const now) noexcept {
+            for (auto *l = from.head.next; l != &from.head;) {
+                auto *t = static_cast<timer *>(l);
+                l = l->next;
+                if (t->deadline <= now) {
+                    t->unlink();
+                    expired.push_back(*t);
+                } else if (&from != &pending) {
+                    t->unlink();
+                    pending.push_back(*t);
+                }
+            }
+        }
+
+        static std::optional<time_point> earliest(list const &l) noexcept {
+            std::optional<time_point> e;
+            for (auto const *i = l.head.next; i != &l.head; i = i->next) {
+                auto const d = static_cast<timer const *>(i)->deadline;
+                if (not e or d < *e) { e = d; }
+            }
+            return e;
+        }
+    };
+
+
+}
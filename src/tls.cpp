@@ -1,6 +1,7 @@
 #include <openssl/err.h>
 #include <openssl/ssl.h>
 
+#include <felspar/io/connect.hpp>
 #include <felspar/io/tls.hpp>
 #include <felspar/io/write.hpp>
 
@@ -136,7 +137,25 @@ auto felspar::io::tls::connect(
         felspar::source_location const &loc) -> warden::task<tls> {
     posix::fd fd = warden.create_socket(AF_INET, SOCK_STREAM, 0);
     co_await warden.connect(fd, addr, addrlen, timeout, loc);
-
+    co_return co_await handshake(
+            warden, std::move(fd), sni_hostname, timeout, loc);
+}
+auto felspar::io::tls::connect(
+        io::warden &warden,
+        std::string hostname,
+        std::uint16_t const port,
+        std::optional<std::chrono::nanoseconds> timeout,
+        felspar::source_location const &loc) -> warden::task<tls> {
+    posix::fd fd = co_await io::connect(warden, hostname, port, timeout, loc);
+    co_return co_await handshake(
+            warden, std::move(fd), hostname.c_str(), timeout, loc);
+}
+auto felspar::io::tls::handshake(
+        io::warden &warden,
+        posix::fd fd,
+        char const *const sni_hostname,
+        std::optional<std::chrono::nanoseconds> timeout,
+        felspar::source_location const &loc) -> warden::task<tls> {
     auto i = std::make_unique<impl>(std::move(fd));
     SSL_set_tlsext_host_name(i->ssl, sni_hostname);
     co_await i->service_operation(
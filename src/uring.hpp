@@ -6,46 +6,176 @@
 
 #include <liburing.h>
 
+#include "recycler.hpp"
+#include "timers.hpp"
+
+#include <cstdint>
+#include <type_traits>
 #include <vector>
 
 
 namespace felspar::io {
 
 
+    /// ### Kernel time outs
+    /**
+     * Fill in the kernel timespec for a time out and return the flags needed
+     * for it. Time outs without slack are relative. Those with slack are
+     * coalesced onto an absolute deadline so that the kernel fires them
+     * together.
+     */
+    inline unsigned kernel_timeout(
+            __kernel_timespec &kts,
+            std::chrono::nanoseconds const timeout,
+            std::chrono::nanoseconds const slack) {
+        auto const split = [&kts](std::chrono::nanoseconds const ns) {
+            auto const seconds =
+                    std::chrono::duration_cast<std::chrono::seconds>(ns);
+            kts.tv_sec = seconds.count();
+            kts.tv_nsec = (ns - seconds).count();
+        };
+        if (slack.count() > 0) {
+            split(coalesce(std::chrono::steady_clock::now() + timeout, slack)
+                          .time_since_epoch());
+            return IORING_TIMEOUT_ABS;
+        } else {
+            split(timeout);
+            return 0;
+        }
+    }
+
+
     struct uring_warden::delivery {
         /// True so long as the IOP instance still exists
         bool iop_exists = true;
         /// True if the completion is now in the outstanding completions list
         bool is_outstanding = false;
+        /// True once the result has been handed to the waiting coroutine
+        bool resumed = false;
         /// The number of IOPs that have been submitted to the queue and not
         /// returned
-        std::size_t iop_count = 1;
+        std::size_t iop_count = 0;
 
         virtual ~delivery() = default;
-        virtual void deliver(int result) = 0;
+        /// Called with the result and flags of each CQE for this IOP
+        virtual void deliver(int result, std::uint32_t flags) = 0;
+    };
+
+
+    /// ### Cross-thread wake ups
+    /**
+     * Other threads write to the `eventfd`, which completes a read that the
+     * warden keeps waiting on it. The read isn't an IOP so it is left out of
+     * the ring statistics.
+     */
+    struct uring_warden::wake_read final : public delivery {
+        explicit wake_read(uring_warden &);
+
+        uring_warden &ward;
+        posix::fd event;
+        std::uint64_t count = {};
+        bool armed = false;
+
+        void deliver(int result, std::uint32_t flags) override;
     };
 
 
     struct uring_warden::impl {
+        explicit impl(uring_warden &w) : wake{w} {}
         ~impl() {
             for (auto *d : outstanding) { delete d; }
         }
 
         ::io_uring uring;
+        options setup;
+        unsigned entries = {};
+        void init(options const &);
+        /// Where completions are allocated from
+        recycler completions;
 
-        /// Fetch another SQE from the uring
-        ::io_uring_sqe *next_sqe();
+        /**
+         * Fetch another SQE from the uring. If there isn't room for `needed`
+         * SQEs the queue is submitted first, so that an IOP and its linked
+         * time out are always submitted together.
+         */
+        ::io_uring_sqe *next_sqe(unsigned needed = 1);
+        /// Submit any queued SQEs, and if asked to, wait for a completion
+        void submit(bool wait = false);
+        /// Re-create the ring if it has proven too small
+        void grow();
+        uring_statistics stats;
 
-        void execute(::io_uring_cqe *);
+        /// Deliver all of the completions that are ready
+        static constexpr std::size_t reap_batch = 64;
+        struct completed {
+            delivery *d;
+            int result;
+            std::uint32_t flags;
+        };
+        void reap();
+        void execute(completed const &);
+        /// Taken from the ring by `submit` to make room, for `reap` to deliver
+        std::vector<completed> overflowed;
 
         std::vector<delivery *> outstanding;
+        /**
+         * Keep a completion whose IOP has gone until the kernel is done with
+         * it, and ask the kernel to cancel the IOP so that happens promptly.
+         */
+        void abandon(delivery *, bool cancel);
+        /// Submit an `IORING_OP_ASYNC_CANCEL` for the completion's IOPs
+        void cancel(delivery *);
+
+        wake_read wake;
+        /// Make sure that the wake up read is waiting in the kernel
+        void watch_wakeups();
+
+        /// True while a set of buffers is registered with the ring
+        bool buffers_registered = false;
+
+        /// Pipes that file data is spliced through on the way to a socket
+        struct splice_pipe {
+            io::pipe ends;
+            std::size_t capacity;
+        };
+        std::vector<splice_pipe> splice_pipes;
+        splice_pipe take_splice_pipe(felspar::source_location const &);
+
+        /// Slots in the registered file table
+        unsigned file_slots = 0;
+        std::vector<int> free_file_slots;
+        int take_file_slot(unsigned slots, felspar::source_location const &);
+        void release_file_slot(int);
+    };
+
+
+    /// ### Provided buffer ring
+    /**
+     * The pool's buffers are all handed to the kernel through a buffer ring.
+     * A read that selects a buffer group is given one of them when its data
+     * arrives, and leased buffers go back into the ring when released.
+     */
+    class uring_warden::buffer_ring final : public buffer_pool {
+        ::io_uring &uring;
+        ::io_uring_buf_ring *ring = nullptr;
+        unsigned const entries;
+
+      public:
+        static constexpr int group = 0;
+
+        buffer_ring(::io_uring &, buffer_pool::options const &);
+        ~buffer_ring();
+
+      protected:
+        void recycle(std::uint16_t) noexcept override;
     };
 
 
     template<typename R>
     struct uring_warden::completion :
     public delivery,
-            public io::completion<R> {
+            public io::completion<R>,
+            public recyclable {
         completion(
                 uring_warden *w,
                 std::optional<std::chrono::nanoseconds> tout,
@@ -57,38 +187,47 @@ namespace felspar::io {
 
         std::optional<std::chrono::nanoseconds> timeout = {};
         __kernel_timespec kts;
+        /// The file descriptor is an index into the registered file table
+        bool fixed_file = false;
 
         ::io_uring_sqe *setup_submission(felspar::coro::coroutine_handle<> h) {
             io::completion<R>::handle = h;
-            return self->ring->next_sqe();
+            auto sqe = self->ring->next_sqe(timeout ? 2 : 1);
+            iop_count = 1;
+            return sqe;
         }
         felspar::coro::coroutine_handle<> setup_timeout(::io_uring_sqe *sqe) {
+            if (fixed_file) { sqe->flags |= IOSQE_FIXED_FILE; }
             ::io_uring_sqe_set_data(sqe, this);
             if (timeout) {
                 sqe->flags |= IOSQE_IO_LINK;
                 auto tsqe = self->ring->next_sqe();
-                kts.tv_sec = 0;
-                kts.tv_nsec = timeout->count();
-                ::io_uring_prep_link_timeout(tsqe, &kts, 0);
+                ::io_uring_prep_link_timeout(
+                        tsqe, &kts,
+                        kernel_timeout(kts, *timeout, self->timeout_slack));
                 ::io_uring_sqe_set_data(tsqe, this);
                 iop_count = 2;
             }
             return felspar::coro::noop_coroutine();
         }
 
-        void deliver(int result) override {
-            if (result < 0) {
-                if (timeout and result == -ECANCELED) {
-                    /// This is the cancelled IOP so we ignore it as we've timed
-                    /// out
+        void deliver(int result, std::uint32_t) override {
+            if (not iop_exists or resumed) {
+                return;
+            } else if (result < 0) {
+                if (timeout and result == -ECANCELED and iop_count > 1) {
+                    /// The linked time out's CQE is still to come, and says
+                    /// whether this timed out or was cancelled
                     return;
                 } else {
                     io::completion<R>::result = {
                             {-result, std::system_category()}, "uring IOP"};
                 }
-            } else {
+            } else if constexpr (std::is_convertible_v<int, R>) {
+                /// Other completions store their own result before this
                 io::completion<R>::result = result;
             }
+            resumed = true;
             io::completion<R>::handle.resume();
         }
         bool delete_due_to_iop_destructed() override {
@@ -96,9 +235,8 @@ namespace felspar::io {
             if (iop_count == 0) {
                 return true;
             } else {
-                /// Cancel IOP
-                is_outstanding = true;
-                self->ring->outstanding.push_back(this);
+                /// Only an IOP that is still waiting needs cancelling
+                self->ring->abandon(this, not resumed);
                 return false;
             }
         }
@@ -106,7 +244,8 @@ namespace felspar::io {
     template<>
     struct uring_warden::completion<void> :
     public delivery,
-            public io::completion<void> {
+            public io::completion<void>,
+            public recyclable {
         completion(
                 uring_warden *w,
                 std::optional<std::chrono::nanoseconds> tout,
@@ -118,37 +257,46 @@ namespace felspar::io {
 
         std::optional<std::chrono::nanoseconds> timeout = {};
         __kernel_timespec kts;
+        /// The file descriptor is an index into the registered file table
+        bool fixed_file = false;
 
         ::io_uring_sqe *setup_submission(felspar::coro::coroutine_handle<> h) {
             io::completion<void>::handle = h;
-            return self->ring->next_sqe();
+            auto sqe = self->ring->next_sqe(timeout ? 2 : 1);
+            iop_count = 1;
+            return sqe;
         }
         felspar::coro::coroutine_handle<> setup_timeout(::io_uring_sqe *sqe) {
+            if (fixed_file) { sqe->flags |= IOSQE_FIXED_FILE; }
             ::io_uring_sqe_set_data(sqe, this);
             if (timeout) {
                 sqe->flags |= IOSQE_IO_LINK;
                 auto tsqe = self->ring->next_sqe();
-                kts.tv_sec = 0;
-                kts.tv_nsec = timeout->count();
-                ::io_uring_prep_link_timeout(tsqe, &kts, 0);
+                ::io_uring_prep_link_timeout(
+                        tsqe, &kts,
+                        kernel_timeout(kts, *timeout, self->timeout_slack));
                 ::io_uring_sqe_set_data(tsqe, this);
                 iop_count = 2;
             }
             return felspar::coro::noop_coroutine();
         }
 
-        void deliver(int result) override {
-            if (result == -ETIME) {
+        void deliver(int result, std::uint32_t) override {
+            if (not iop_exists or resumed) {
+                return;
+            } else if (result == -ETIME) {
                 io::completion<void>::result = {
                         {ETIME, std::system_category()}, "uring IOP timeout"};
-            } else if (timeout and result == -ECANCELED) {
-                /// This is the cancelled IOP so we ignore it as we've timed
-                /// out
+            } else if (
+                    timeout and result == -ECANCELED and iop_count > 1) {
+                /// The linked time out's CQE is still to come, and says
+                /// whether this timed out or was cancelled
                 return;
             } else if (result < 0) {
                 io::completion<void>::result = {
                         {-result, std::system_category()}, "uring IOP"};
             }
+            resumed = true;
             io::completion<void>::handle.resume();
         }
         bool delete_due_to_iop_destructed() override {
@@ -156,9 +304,8 @@ namespace felspar::io {
             if (iop_count == 0) {
                 return true;
             } else {
-                /// Cancel IOP
-                is_outstanding = true;
-                self->ring->outstanding.push_back(this);
+                /// Only an IOP that is still waiting needs cancelling
+                self->ring->abandon(this, not resumed);
                 return false;
             }
         }
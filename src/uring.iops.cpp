@@ -1,8 +1,14 @@
+#include "iovec.hpp"
 #include "uring.hpp"
 
+#include <fcntl.h>
 #include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <deque>
 #include <iostream>
+#include <string>
 
 
 struct felspar::io::uring_warden::close_completion : public completion<void> {
@@ -19,7 +25,7 @@ struct felspar::io::uring_warden::close_completion : public completion<void> {
 };
 felspar::io::iop<void> felspar::io::uring_warden::do_close(
         int fd, felspar::source_location const &loc) {
-    return {new close_completion{this, fd, loc}};
+    return {new (ring->completions) close_completion{this, fd, loc}};
 }
 
 
@@ -27,24 +33,35 @@ struct felspar::io::uring_warden::sleep_completion : public completion<void> {
     sleep_completion(
             uring_warden *s,
             std::chrono::nanoseconds ns,
+            std::chrono::nanoseconds sl,
             felspar::source_location const &loc)
-    : completion<void>{s, {}, loc} {
-        kts = {{}, ns.count()};
-    }
+    : completion<void>{s, {}, loc}, duration{ns}, slack{sl} {}
+    std::chrono::nanoseconds duration, slack;
     felspar::coro::coroutine_handle<>
             await_suspend(felspar::coro::coroutine_handle<> h) override {
         auto sqe = setup_submission(h);
-        ::io_uring_prep_timeout(sqe, &kts, 0, 0);
+        ::io_uring_prep_timeout(
+                sqe, &kts, 0, kernel_timeout(kts, duration, slack));
         ::io_uring_sqe_set_data(sqe, this);
         return felspar::coro::noop_coroutine();
     }
-    void deliver(int result) override {
-        completion<void>::deliver(result == -ETIME ? 0 : result);
+    void deliver(int result, std::uint32_t flags) override {
+        completion<void>::deliver(result == -ETIME ? 0 : result, flags);
     }
 };
+void felspar::io::uring_warden::do_cancel_all(
+        socket_descriptor const fd, felspar::source_location const &) {
+    auto sqe = ring->next_sqe();
+    ::io_uring_prep_cancel_fd(sqe, fd, IORING_ASYNC_CANCEL_ALL);
+    ::io_uring_sqe_set_data(sqe, nullptr);
+}
+
+
 felspar::io::iop<void> felspar::io::uring_warden::do_sleep(
-        std::chrono::nanoseconds ns, felspar::source_location const &loc) {
-    return {new sleep_completion{this, ns, loc}};
+        std::chrono::nanoseconds ns,
+        std::chrono::nanoseconds slack,
+        felspar::source_location const &loc) {
+    return {new (ring->completions) sleep_completion{this, ns, slack, loc}};
 }
 
 
@@ -71,7 +88,106 @@ felspar::io::iop<std::size_t> felspar::io::uring_warden::do_read_some(
         std::span<std::byte> b,
         std::optional<std::chrono::nanoseconds> timeout,
         felspar::source_location const &loc) {
-    return {new read_some_completion{this, fd, b, timeout, loc}};
+    return {new (ring->completions)
+                    read_some_completion{this, fd, b, timeout, loc}};
+}
+
+
+/// Handles without a registration are read with `read_some` instead
+struct felspar::io::uring_warden::read_fixed_completion :
+public completion<std::size_t> {
+    read_fixed_completion(
+            uring_warden *s,
+            int f,
+            registered_buffer const &b,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc}, fd{f}, buffer{b} {}
+    int fd;
+    registered_buffer buffer;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_read_fixed(
+                sqe, fd, buffer.data().data(), buffer.size(), 0,
+                buffer.native_index());
+        return setup_timeout(sqe);
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::uring_warden::do_read_fixed(
+        socket_descriptor fd,
+        registered_buffer const &b,
+        std::optional<std::chrono::nanoseconds> timeout,
+        felspar::source_location const &loc) {
+    if (b.native_index() < 0) {
+        return do_read_some(fd, b.data(), timeout, loc);
+    } else {
+        return {new (ring->completions)
+                        read_fixed_completion{this, fd, b, timeout, loc}};
+    }
+}
+
+
+/**
+ * The kernel picks a buffer from the ring only once data has arrived, and
+ * reports which one it used in the CQE flags.
+ */
+struct felspar::io::uring_warden::read_pooled_completion :
+public completion<buffer_lease> {
+    read_pooled_completion(
+            uring_warden *s,
+            int f,
+            buffer_pool &p,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<buffer_lease>{s, t, loc}, fd{f}, pool{p} {}
+    int fd;
+    buffer_pool &pool;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_read(
+                sqe, fd, nullptr, pool.configuration().buffer_size, 0);
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = buffer_ring::group;
+        return setup_timeout(sqe);
+    }
+    void deliver(int result, std::uint32_t flags) override {
+        if (flags & IORING_CQE_F_BUFFER) {
+            auto const id =
+                    static_cast<std::uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+            if (not iop_exists or result < 0) {
+                pool.give_back(id);
+            } else {
+                io::completion<buffer_lease>::result = pool.lease(id, result);
+            }
+        } else if (result >= 0) {
+            io::completion<buffer_lease>::result = buffer_lease{};
+        } else if (result == -ENOBUFS) {
+            pool.exhausted();
+        }
+        if (iop_exists) { completion<buffer_lease>::deliver(result, flags); }
+    }
+};
+felspar::io::iop<felspar::io::buffer_lease>
+        felspar::io::uring_warden::do_read_pooled(
+                socket_descriptor fd,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &loc) {
+    return {new (ring->completions) read_pooled_completion{
+            this, fd, read_buffers(), timeout, loc}};
+}
+
+
+felspar::io::iop<std::size_t> felspar::io::uring_warden::read_some(
+        fixed_fd const &fd,
+        std::span<std::byte> b,
+        std::optional<std::chrono::nanoseconds> timeout,
+        felspar::source_location const &loc) {
+    auto *const c = new (ring->completions)
+            read_some_completion{this, fd.native_index(), b, timeout, loc};
+    c->fixed_file = true;
+    return {c};
 }
 
 
@@ -98,7 +214,404 @@ felspar::io::iop<std::size_t> felspar::io::uring_warden::do_write_some(
         std::span<std::byte const> b,
         std::optional<std::chrono::nanoseconds> t,
         felspar::source_location const &loc) {
-    return {new write_some_completion{this, fd, b, t, loc}};
+    return {new (ring->completions) write_some_completion{this, fd, b, t, loc}};
+}
+
+
+struct felspar::io::uring_warden::read_some_v_completion :
+public completion<std::size_t> {
+    read_some_v_completion(
+            uring_warden *s,
+            socket_descriptor f,
+            std::span<std::span<std::byte> const> b,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc}, fd{f}, iovecs{iovecs_for(b)} {}
+    socket_descriptor fd;
+    std::vector<::iovec> iovecs;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_readv(sqe, fd, iovecs.data(), iovecs.size(), 0);
+        return setup_timeout(sqe);
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::uring_warden::do_read_some_v(
+        socket_descriptor fd,
+        std::span<std::span<std::byte> const> b,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return {new (ring->completions)
+                    read_some_v_completion{this, fd, b, t, loc}};
+}
+
+
+struct felspar::io::uring_warden::write_some_v_completion :
+public completion<std::size_t> {
+    write_some_v_completion(
+            uring_warden *s,
+            socket_descriptor f,
+            std::span<std::span<std::byte const> const> b,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc}, fd{f}, iovecs{iovecs_for(b)} {}
+    socket_descriptor fd;
+    std::vector<::iovec> iovecs;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_writev(sqe, fd, iovecs.data(), iovecs.size(), 0);
+        return setup_timeout(sqe);
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::uring_warden::do_write_some_v(
+        socket_descriptor fd,
+        std::span<std::span<std::byte const> const> b,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return {new (ring->completions)
+                    write_some_v_completion{this, fd, b, t, loc}};
+}
+
+
+/**
+ * A zero copy send produces two CQEs. The first has the result of the send
+ * and is flagged with `IORING_CQE_F_MORE` if a notification is to follow. The
+ * notification comes once the kernel no longer needs the buffer.
+ */
+struct felspar::io::uring_warden::send_zc_completion :
+public completion<std::size_t> {
+    send_zc_completion(
+            uring_warden *s,
+            socket_descriptor f,
+            std::span<std::byte const> b,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc}, fd{f}, bytes{b} {}
+    socket_descriptor fd;
+    std::span<std::byte const> bytes;
+    int sent = 0;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_send_zc(sqe, fd, bytes.data(), bytes.size(), 0, 0);
+        return setup_timeout(sqe);
+    }
+    void deliver(int result, std::uint32_t flags) override {
+        if (flags & IORING_CQE_F_NOTIF) {
+            completion<std::size_t>::deliver(sent, flags);
+        } else if (flags & IORING_CQE_F_MORE) {
+            sent = result;
+        } else {
+            completion<std::size_t>::deliver(result, flags);
+        }
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::uring_warden::do_send_zc(
+        socket_descriptor fd,
+        std::span<std::byte const> b,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return {new (ring->completions) send_zc_completion{this, fd, b, t, loc}};
+}
+
+
+/**
+ * The file is spliced into a pipe and then from the pipe to the socket. The
+ * second splice is only submitted once the first has said how much it moved,
+ * and the time out only covers the second. A pipe that still holds data
+ * when the IOP is done is closed rather than being used again.
+ */
+struct felspar::io::uring_warden::send_file_completion :
+public completion<std::size_t> {
+    send_file_completion(
+            uring_warden *s,
+            socket_descriptor sk,
+            socket_descriptor f,
+            std::uint64_t const o,
+            std::size_t const l,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc},
+      sock{sk},
+      file{f},
+      offset{o},
+      length{l} {}
+    ~send_file_completion() {
+        if (empty) { self->ring->splice_pipes.push_back(std::move(pipe)); }
+    }
+    socket_descriptor sock, file;
+    std::uint64_t offset;
+    std::size_t length;
+    impl::splice_pipe pipe;
+    bool empty = false, draining = false;
+    int moved = 0;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        pipe = self->ring->take_splice_pipe(loc);
+        empty = true;
+        handle = h;
+        auto sqe = self->ring->next_sqe();
+        ::io_uring_prep_splice(
+                sqe, file, offset, pipe.ends.write.native_handle(), -1,
+                std::min(length, pipe.capacity), 0);
+        ::io_uring_sqe_set_data(sqe, this);
+        iop_count = 1;
+        return felspar::coro::noop_coroutine();
+    }
+    void deliver(int result, std::uint32_t flags) override {
+        if (draining) {
+            /**
+             * Only the splice's CQE says how much is left in the pipe. The
+             * linked time out's CQE is negative, as is a splice that didn't
+             * move anything, and both leave the pipe as it was.
+             */
+            if (result >= 0) { empty = result == moved; }
+            completion<std::size_t>::deliver(result, flags);
+        } else if (result <= 0 or not iop_exists) {
+            empty = result <= 0;
+            completion<std::size_t>::deliver(result, flags);
+        } else {
+            moved = result;
+            empty = false;
+            draining = true;
+            auto sqe = self->ring->next_sqe(timeout ? 2 : 1);
+            ::io_uring_prep_splice(
+                    sqe, pipe.ends.read.native_handle(), -1, sock, -1, moved,
+                    0);
+            ++iop_count;
+            if (timeout) {
+                sqe->flags |= IOSQE_IO_LINK;
+                auto tsqe = self->ring->next_sqe();
+                ::io_uring_prep_link_timeout(
+                        tsqe, &kts,
+                        kernel_timeout(kts, *timeout, self->timeout_slack));
+                ::io_uring_sqe_set_data(tsqe, this);
+                ++iop_count;
+            }
+            ::io_uring_sqe_set_data(sqe, this);
+        }
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::uring_warden::do_send_file_some(
+        socket_descriptor sock,
+        socket_descriptor file,
+        std::uint64_t offset,
+        std::size_t length,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    return {new (ring->completions) send_file_completion{
+            this, sock, file, offset, length, t, loc}};
+}
+
+
+felspar::io::iop<std::size_t> felspar::io::uring_warden::write_some(
+        fixed_fd const &fd,
+        std::span<std::byte const> b,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    auto *const c = new (ring->completions)
+            write_some_completion{this, fd.native_index(), b, t, loc};
+    c->fixed_file = true;
+    return {c};
+}
+
+
+struct felspar::io::uring_warden::write_fixed_completion :
+public completion<std::size_t> {
+    write_fixed_completion(
+            uring_warden *s,
+            int f,
+            registered_buffer const &b,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, t, loc}, fd{f}, buffer{b} {}
+    int fd;
+    registered_buffer buffer;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_write_fixed(
+                sqe, fd, buffer.data().data(), buffer.size(), 0,
+                buffer.native_index());
+        return setup_timeout(sqe);
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::uring_warden::do_write_fixed(
+        socket_descriptor fd,
+        registered_buffer const &b,
+        std::optional<std::chrono::nanoseconds> t,
+        felspar::source_location const &loc) {
+    if (b.native_index() < 0) {
+        return do_write_some(fd, b.data(), t, loc);
+    } else {
+        return {new (ring->completions)
+                        write_fixed_completion{this, fd, b, t, loc}};
+    }
+}
+
+
+struct felspar::io::uring_warden::read_at_completion :
+public completion<std::size_t> {
+    read_at_completion(
+            uring_warden *s,
+            int f,
+            std::span<std::byte> b,
+            std::uint64_t const o,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, {}, loc}, fd{f}, bytes{b}, offset{o} {}
+    int fd;
+    std::span<std::byte> bytes;
+    std::uint64_t offset;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_read(sqe, fd, bytes.data(), bytes.size(), offset);
+        return setup_timeout(sqe);
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::uring_warden::do_read_at(
+        socket_descriptor fd,
+        std::span<std::byte> b,
+        std::uint64_t offset,
+        felspar::source_location const &loc) {
+    return {new (ring->completions)
+                    read_at_completion{this, fd, b, offset, loc}};
+}
+
+
+struct felspar::io::uring_warden::write_at_completion :
+public completion<std::size_t> {
+    write_at_completion(
+            uring_warden *s,
+            int f,
+            std::span<std::byte const> b,
+            std::uint64_t const o,
+            felspar::source_location const &loc)
+    : completion<std::size_t>{s, {}, loc}, fd{f}, bytes{b}, offset{o} {}
+    int fd;
+    std::span<std::byte const> bytes;
+    std::uint64_t offset;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_write(sqe, fd, bytes.data(), bytes.size(), offset);
+        return setup_timeout(sqe);
+    }
+};
+felspar::io::iop<std::size_t> felspar::io::uring_warden::do_write_at(
+        socket_descriptor fd,
+        std::span<std::byte const> b,
+        std::uint64_t offset,
+        felspar::source_location const &loc) {
+    return {new (ring->completions)
+                    write_at_completion{this, fd, b, offset, loc}};
+}
+
+
+/// The path is copied so that the caller's string can go away once submitted
+struct felspar::io::uring_warden::open_completion :
+public completion<socket_descriptor> {
+    open_completion(
+            uring_warden *s,
+            char const *p,
+            int const f,
+            int const m,
+            felspar::source_location const &loc)
+    : completion<socket_descriptor>{s, {}, loc}, path{p}, flags{f}, mode{m} {}
+    std::string path;
+    int flags, mode;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_openat(
+                sqe, AT_FDCWD, path.c_str(), flags | O_CLOEXEC, mode);
+        return setup_timeout(sqe);
+    }
+};
+felspar::io::iop<felspar::io::socket_descriptor>
+        felspar::io::uring_warden::do_open(
+                char const *path,
+                int flags,
+                int mode,
+                felspar::source_location const &loc) {
+    return {new (ring->completions)
+                    open_completion{this, path, flags, mode, loc}};
+}
+
+
+struct felspar::io::uring_warden::fsync_completion : public completion<void> {
+    fsync_completion(
+            uring_warden *s,
+            int f,
+            bool const d,
+            felspar::source_location const &loc)
+    : completion<void>{s, {}, loc}, fd{f}, data_only{d} {}
+    int fd;
+    bool data_only;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_fsync(
+                sqe, fd, data_only ? IORING_FSYNC_DATASYNC : 0u);
+        return setup_timeout(sqe);
+    }
+};
+felspar::io::iop<void> felspar::io::uring_warden::do_fsync(
+        socket_descriptor fd,
+        bool data_only,
+        felspar::source_location const &loc) {
+    return {new (ring->completions)
+                    fsync_completion{this, fd, data_only, loc}};
+}
+
+
+/// The kernel writes the `statx` into the completion
+struct felspar::io::uring_warden::stat_completion :
+public completion<file_status> {
+    stat_completion(
+            uring_warden *s,
+            int f,
+            char const *p,
+            felspar::source_location const &loc)
+    : completion<file_status>{s, {}, loc}, fd{f}, by_fd{p == nullptr} {
+        if (p) { path = p; }
+    }
+    int fd;
+    bool by_fd;
+    std::string path;
+    struct ::statx status;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_statx(
+                sqe, by_fd ? fd : AT_FDCWD, path.c_str(),
+                by_fd ? AT_EMPTY_PATH : 0, STATX_BASIC_STATS, &status);
+        return setup_timeout(sqe);
+    }
+    void deliver(int result, std::uint32_t flags) override {
+        if (result >= 0 and iop_exists and not resumed) {
+            io::completion<file_status>::result = file_status{
+                    .size = status.stx_size,
+                    .mode = status.stx_mode,
+                    .links = status.stx_nlink,
+                    .inode = status.stx_ino,
+                    .modified = std::chrono::system_clock::time_point{
+                            std::chrono::duration_cast<
+                                    std::chrono::system_clock::duration>(
+                                    std::chrono::seconds{
+                                            status.stx_mtime.tv_sec}
+                                    + std::chrono::nanoseconds{
+                                            status.stx_mtime.tv_nsec})}};
+        }
+        completion<file_status>::deliver(result, flags);
+    }
+};
+felspar::io::iop<felspar::io::file_status> felspar::io::uring_warden::do_stat(
+        socket_descriptor fd,
+        char const *path,
+        felspar::source_location const &loc) {
+    return {new (ring->completions) stat_completion{this, fd, path, loc}};
 }
 
 
@@ -125,7 +638,148 @@ felspar::io::iop<felspar::io::socket_descriptor>
                 socket_descriptor fd,
                 std::optional<std::chrono::nanoseconds> timeout,
                 felspar::source_location const &loc) {
-    return {new accept_completion{this, fd, timeout, loc}};
+    return {new (ring->completions) accept_completion{this, fd, timeout, loc}};
+}
+
+
+felspar::io::iop<felspar::io::socket_descriptor>
+        felspar::io::uring_warden::accept(
+                fixed_fd const &fd,
+                std::optional<std::chrono::nanoseconds> timeout,
+                felspar::source_location const &loc) {
+    auto *const c = new (ring->completions)
+            accept_completion{this, fd.native_index(), timeout, loc};
+    c->fixed_file = true;
+    return {c};
+}
+
+
+/// The connection is put into a slot that is taken before submission
+struct felspar::io::uring_warden::accept_direct_completion :
+public completion<fixed_fd> {
+    accept_direct_completion(
+            uring_warden *s,
+            socket_descriptor f,
+            std::optional<std::chrono::nanoseconds> t,
+            felspar::source_location const &loc)
+    : completion<fixed_fd>{s, t, loc}, fd{f} {}
+    ~accept_direct_completion() {
+        if (slot >= 0) { self->ring->release_file_slot(slot); }
+    }
+    socket_descriptor fd = {};
+    int slot = -1;
+    felspar::coro::coroutine_handle<>
+            await_suspend(felspar::coro::coroutine_handle<> h) override {
+        slot = self->ring->take_file_slot(self->fixed_file_slots, loc);
+        auto sqe = setup_submission(h);
+        ::io_uring_prep_accept_direct(sqe, fd, nullptr, nullptr, 0, slot);
+        return setup_timeout(sqe);
+    }
+    void deliver(int result, std::uint32_t flags) override {
+        if (result >= 0) {
+            io::completion<fixed_fd>::result =
+                    fixed_fd{self, std::exchange(slot, -1)};
+        }
+        completion<fixed_fd>::deliver(result, flags);
+    }
+};
+auto felspar::io::uring_warden::accept_direct(
+        socket_descriptor fd,
+        std::optional<std::chrono::nanoseconds> timeout,
+        felspar::source_location const &loc) -> iop<fixed_fd> {
+    return {new (ring->completions)
+                    accept_direct_completion{this, fd, timeout, loc}};
+}
+
+
+/**
+ * A single `IORING_ACCEPT_MULTISHOT` submission produces a CQE for every
+ * connection until it fails or is cancelled. Connections that arrive while
+ * the stream isn't waiting are queued. If the kernel ends the submission it
+ * is submitted again the next time a connection is asked for.
+ */
+struct felspar::io::uring_warden::accept_multishot_completion :
+public delivery,
+        public recyclable {
+    accept_multishot_completion(uring_warden *s, socket_descriptor f)
+    : self{s}, fd{f} {}
+    uring_warden *self;
+    socket_descriptor fd;
+    bool armed = false;
+    std::deque<int> accepted;
+    felspar::coro::coroutine_handle<> waiting = {};
+
+    void deliver(int result, std::uint32_t flags) override {
+        if (not(flags & IORING_CQE_F_MORE)) { armed = false; }
+        if (not iop_exists) {
+            if (result >= 0) { ::close(result); }
+        } else {
+            accepted.push_back(result);
+            if (waiting) { std::exchange(waiting, {}).resume(); }
+        }
+    }
+
+    bool await_ready() const noexcept { return not accepted.empty(); }
+    void await_suspend(felspar::coro::coroutine_handle<> h) {
+        if (not armed) {
+            auto sqe = self->ring->next_sqe();
+            ::io_uring_prep_multishot_accept(sqe, fd, nullptr, nullptr, 0);
+            ::io_uring_sqe_set_data(sqe, this);
+            armed = true;
+            ++iop_count;
+        }
+        waiting = h;
+    }
+    int await_resume() {
+        auto const result = accepted.front();
+        accepted.pop_front();
+        return result;
+    }
+
+    /// Called when the stream goes away
+    void abandon() {
+        iop_exists = false;
+        for (auto const s : accepted) {
+            if (s >= 0) { ::close(s); }
+        }
+        if (iop_count == 0) {
+            delete this;
+        } else {
+            self->ring->abandon(this, armed);
+        }
+    }
+};
+felspar::io::warden::stream<felspar::io::socket_descriptor>
+        felspar::io::uring_warden::accept_multishot(
+                uring_warden &self,
+                socket_descriptor fd,
+                felspar::source_location loc) {
+    struct owner {
+        accept_multishot_completion *comp;
+        ~owner() { comp->abandon(); }
+    } shot{new (self.ring->completions) accept_multishot_completion{&self, fd}};
+    for (bool first = true;; first = false) {
+        auto const s = co_await *shot.comp;
+        if (s >= 0) {
+            co_yield s;
+        } else if (s == -EINVAL and first) {
+            /// Kernels before 5.19 don't support multishot accept
+            auto single = self.warden::do_accept_stream(fd, loc);
+            while (auto cnx = co_await single.next()) { co_yield *cnx; }
+            co_return;
+        } else if (s != -EBADF and s != -ECANCELED) {
+            throw felspar::stdexcept::system_error{
+                    -s, std::system_category(), "accept", loc};
+        } else {
+            /// The socket was closed or `cancel_all` was used on it
+            co_return;
+        }
+    }
+}
+felspar::io::warden::stream<felspar::io::socket_descriptor>
+        felspar::io::uring_warden::do_accept_stream(
+                socket_descriptor fd, felspar::source_location const &loc) {
+    return accept_multishot(*this, fd, loc);
 }
 
 
@@ -154,7 +808,8 @@ felspar::io::iop<void> felspar::io::uring_warden::do_connect(
         socklen_t addrlen,
         std::optional<std::chrono::nanoseconds> timeout,
         felspar::source_location const &loc) {
-    return {new connect_completion{this, fd, addr, addrlen, timeout, loc}};
+    return {new (ring->completions)
+                    connect_completion{this, fd, addr, addrlen, timeout, loc}};
 }
 
 
@@ -179,11 +834,13 @@ felspar::io::iop<void> felspar::io::uring_warden::do_read_ready(
         socket_descriptor fd,
         std::optional<std::chrono::nanoseconds> timeout,
         felspar::source_location const &loc) {
-    return {new poll_completion{this, fd, POLLIN, timeout, loc}};
+    return {new (ring->completions)
+                    poll_completion{this, fd, POLLIN, timeout, loc}};
 }
 felspar::io::iop<void> felspar::io::uring_warden::do_write_ready(
         socket_descriptor fd,
         std::optional<std::chrono::nanoseconds> timeout,
         felspar::source_location const &loc) {
-    return {new poll_completion{this, fd, POLLOUT, timeout, loc}};
+    return {new (ring->completions)
+                    poll_completion{this, fd, POLLOUT, timeout, loc}};
 }
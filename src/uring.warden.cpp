@@ -1,67 +1,489 @@
 #include "uring.hpp"
 
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
 
 /// ## `felspar::io::uring_warden`
 
 
+felspar::io::uring_warden::uring_warden(options const &o)
+: ring{std::make_unique<impl>(*this)} {
+    ring->init(o);
+}
 felspar::io::uring_warden::uring_warden(unsigned entries, unsigned flags)
-: ring{std::make_unique<impl>()} {
-    if (auto const ret = ::io_uring_queue_init(entries, &ring->uring, flags);
-        ret < 0) {
-        throw felspar::stdexcept::system_error{
-                -ret, std::system_category(), "uring_queue_init"};
-    }
+: uring_warden{options{.entries = entries, .flags = flags}} {}
+felspar::io::uring_warden::uring_warden(
+        frame_pool::options const &fo, options const &o)
+: warden{fo}, ring{std::make_unique<impl>(*this)} {
+    ring->init(o);
 }
+felspar::io::uring_warden::uring_warden(
+        frame_pool::options const &fo, unsigned entries, unsigned flags)
+: uring_warden{fo, options{.entries = entries, .flags = flags}} {}
 felspar::io::uring_warden::~uring_warden() {
+    /// The buffer ring has to be unregistered before the ring goes away
+    buffers.reset();
     if (ring) { ::io_uring_queue_exit(&ring->uring); }
 }
 
 
+auto felspar::io::uring_warden::ring_statistics() const noexcept
+        -> uring_statistics const & {
+    return ring->stats;
+}
+
+
+std::unique_ptr<felspar::io::buffer_pool>
+        felspar::io::uring_warden::make_buffer_pool(
+                buffer_pool::options const &o) {
+    return std::make_unique<buffer_ring>(ring->uring, o);
+}
+
+
 void felspar::io::uring_warden::run_until(
         felspar::coro::coroutine_handle<> coro) {
+    if (grow_ring and not buffers) { ring->grow(); }
+    ring->watch_wakeups();
     coro.resume();
     while (not coro.done()) {
-        ::io_uring_submit(&ring->uring);
-
-        ::io_uring_cqe *cqe = {};
-        auto const ret = ::io_uring_wait_cqe(&ring->uring, &cqe);
-        if (ret < 0) {
-            throw felspar::stdexcept::system_error{
-                    -ret, std::system_category(), "uring_wait_cqe"};
-        }
-        ring->execute(cqe);
-        while (::io_uring_peek_cqe(&ring->uring, &cqe) == 0) {
-            ring->execute(cqe);
+        ++loop_stats.waits;
+        ring->submit(true);
+        ring->reap();
+        if (::io_uring_cq_has_overflow(&ring->uring)) {
+            ++ring->stats.cq_overflows;
         }
     }
+    ring->stats.cqes_dropped = *ring->uring.cq.koverflow;
 }
 
 
 void felspar::io::uring_warden::run_batch() {
-    ::io_uring_submit(&ring->uring);
-    ::io_uring_cqe *cqe = {};
-    while (::io_uring_peek_cqe(&ring->uring, &cqe) == 0) { ring->execute(cqe); }
+    ring->watch_wakeups();
+    ring->submit();
+    if (ring->setup.defer_taskrun) {
+        /// Completion work is only done when it is asked for
+        ++ring->stats.kernel_enters;
+        ::io_uring_get_events(&ring->uring);
+    }
+    ring->reap();
 }
 
 
 /// ## `felspar::io::uring_warden::impl`
 
 
-::io_uring_sqe *felspar::io::uring_warden::impl::next_sqe() {
+void felspar::io::uring_warden::impl::init(options const &o) {
+    ::io_uring_params params{};
+    params.flags = o.flags | IORING_SETUP_CQSIZE;
+    params.cq_entries = 4 * o.entries;
+    if (o.single_issuer or o.defer_taskrun) {
+        params.flags |= IORING_SETUP_SINGLE_ISSUER;
+    }
+    if (o.defer_taskrun) { params.flags |= IORING_SETUP_DEFER_TASKRUN; }
+    if (o.coop_taskrun) {
+        params.flags |= IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG;
+    }
+    if (o.polling) {
+        if (o.defer_taskrun) {
+            throw felspar::stdexcept::logic_error{
+                    "SQ polling can't be used together with defer_taskrun"};
+        }
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = o.polling->idle.count();
+        if (o.polling->cpu) {
+            params.flags |= IORING_SETUP_SQ_AFF;
+            params.sq_thread_cpu = *o.polling->cpu;
+        }
+    }
+    if (auto const ret =
+                ::io_uring_queue_init_params(o.entries, &uring, &params);
+        ret < 0) {
+        throw felspar::stdexcept::system_error{
+                -ret, std::system_category(), "uring_queue_init"};
+    }
+    if (o.polling and not(params.features & IORING_FEAT_SQPOLL_NONFIXED)) {
+        /// Older kernels can only poll for IOPs on registered files
+        ::io_uring_queue_exit(&uring);
+        throw felspar::stdexcept::system_error{
+                ENOTSUP, std::system_category(),
+                "SQ polling needs IORING_FEAT_SQPOLL_NONFIXED"};
+    }
+    if (o.register_ring_fd) {
+        if (auto const ret = ::io_uring_register_ring_fd(&uring); ret < 0) {
+            ::io_uring_queue_exit(&uring);
+            throw felspar::stdexcept::system_error{
+                    -ret, std::system_category(), "io_uring_register_ring_fd"};
+        }
+    }
+    setup = o;
+    entries = params.sq_entries;
+}
+
+
+::io_uring_sqe *
+        felspar::io::uring_warden::impl::next_sqe(unsigned const needed) {
+    if (::io_uring_sq_space_left(&uring) < needed) {
+        ++stats.sq_full_submits;
+        submit();
+        /// The polling thread may not have taken the SQEs yet
+        while (setup.polling and ::io_uring_sq_space_left(&uring) < needed) {
+            ::io_uring_sqring_wait(&uring);
+        }
+    }
     ::io_uring_sqe *sqe = ::io_uring_get_sqe(&uring);
+    if (not sqe) {
+        /// Submitting makes room once any overflowed completions are reaped
+        submit();
+        sqe = ::io_uring_get_sqe(&uring);
+    }
     if (not sqe) {
         throw felspar::stdexcept::runtime_error{
                 "No more SQEs are available in the ring"};
     }
+    stats.peak_in_flight = std::max(stats.peak_in_flight, ++stats.in_flight);
     return sqe;
 }
 
 
-void felspar::io::uring_warden::impl::execute(::io_uring_cqe *cqe) {
-    auto d = reinterpret_cast<delivery *>(::io_uring_cqe_get_data(cqe));
-    int result = cqe->res;
-    ::io_uring_cqe_seen(&uring, cqe);
-    d->deliver(result);
+void felspar::io::uring_warden::impl::submit(bool const wait) {
+    /// There is no need to wait if completions are already waiting
+    bool const waiting =
+            wait and overflowed.empty() and not ::io_uring_cq_ready(&uring);
+    if (not waiting and not ::io_uring_sq_ready(&uring)) { return; }
+    if (setup.polling) {
+        /// The kernel is only entered if the polling thread has gone to sleep
+        bool const asleep =
+                __atomic_load_n(uring.sq.kflags, __ATOMIC_RELAXED)
+                & IORING_SQ_NEED_WAKEUP;
+        if (asleep) { ++stats.sq_wakeups; }
+        if (asleep or waiting) { ++stats.kernel_enters; }
+    } else {
+        ++stats.kernel_enters;
+    }
+    auto ret = waiting ? ::io_uring_submit_and_wait(&uring, 1)
+                       : ::io_uring_submit(&uring);
+    if (ret == -EBUSY or ret == -EAGAIN) {
+        /**
+         * The kernel is holding completions that didn't fit in the completion
+         * queue. They are flushed into the queue and moved out of it before
+         * the SQEs are submitted again. This can happen while an IOP is being
+         * suspended, so they are only delivered by the next `reap`, and the
+         * second submit doesn't wait as there is now something to deliver.
+         */
+        ++stats.kernel_enters;
+        ::io_uring_get_events(&uring);
+        std::array<::io_uring_cqe *, reap_batch> cqes;
+        while (auto const count = ::io_uring_peek_batch_cqe(
+                       &uring, cqes.data(), cqes.size())) {
+            for (std::size_t index{}; index < count; ++index) {
+                overflowed.push_back(
+                        {reinterpret_cast<delivery *>(
+                                 ::io_uring_cqe_get_data(cqes[index])),
+                         cqes[index]->res, cqes[index]->flags});
+            }
+            ::io_uring_cq_advance(&uring, count);
+        }
+        ++stats.kernel_enters;
+        ret = ::io_uring_submit(&uring);
+    }
+    if (ret < 0 and ret != -EBUSY and ret != -EAGAIN and ret != -EINTR) {
+        throw felspar::stdexcept::system_error{
+                -ret, std::system_category(), "uring_submit"};
+    }
+}
+
+
+void felspar::io::uring_warden::impl::grow() {
+    auto const wanted = std::min<std::size_t>(
+            std::bit_ceil(stats.peak_in_flight), 32768);
+    if (stats.in_flight or file_slots or buffers_registered
+        or wanted <= entries) {
+        return;
+    }
+    /// The old ring is only closed once the larger one has been set up
+    auto old = uring;
+    auto larger = setup;
+    larger.entries = wanted;
+    try {
+        init(larger);
+    } catch (...) {
+        uring = old;
+        throw;
+    }
+    ::io_uring_queue_exit(&old);
+    ++stats.resizes;
+    /// The old ring took the wake up read with it
+    wake.armed = false;
+}
+
+
+void felspar::io::uring_warden::impl::abandon(
+        delivery *const d, bool const cancel_iop) {
+    d->is_outstanding = true;
+    outstanding.push_back(d);
+    if (cancel_iop) { cancel(d); }
+}
+
+
+void felspar::io::uring_warden::impl::cancel(delivery *const d) {
+    /**
+     * This is called when IOPs are destroyed, so it must not throw. If there
+     * is no room for the cancellation then the IOP is left to finish in its
+     * own time.
+     */
+    auto *sqe = ::io_uring_get_sqe(&uring);
+    if (not sqe) {
+        ::io_uring_submit(&uring);
+        sqe = ::io_uring_get_sqe(&uring);
+    }
+    if (not sqe) { return; }
+    ::io_uring_prep_cancel(sqe, d, 0);
+    ::io_uring_sqe_set_data(sqe, nullptr);
+    ++stats.cancellations;
+    stats.peak_in_flight = std::max(stats.peak_in_flight, ++stats.in_flight);
+}
+
+
+void felspar::io::uring_warden::impl::reap() {
+    while (not overflowed.empty()) {
+        for (auto const &c : std::exchange(overflowed, {})) { execute(c); }
+    }
+    std::array<::io_uring_cqe *, reap_batch> cqes;
+    std::array<completed, reap_batch> batch;
+    while (auto const count = ::io_uring_peek_batch_cqe(
+                   &uring, cqes.data(), cqes.size())) {
+        /// The CQ space is handed back before any coroutines are resumed
+        for (std::size_t index{}; index < count; ++index) {
+            batch[index] = {
+                    reinterpret_cast<delivery *>(
+                            ::io_uring_cqe_get_data(cqes[index])),
+                    cqes[index]->res, cqes[index]->flags};
+        }
+        ::io_uring_cq_advance(&uring, count);
+        for (std::size_t index{}; index < count; ++index) {
+            execute(batch[index]);
+        }
+    }
+}
+
+
+void felspar::io::uring_warden::impl::execute(completed const &c) {
+    auto *const d = c.d;
+    /// The wake up read isn't an IOP
+    if (d == &wake) {
+        wake.deliver(c.result, c.flags);
+        return;
+    }
+    if (not(c.flags & IORING_CQE_F_MORE)) { --stats.in_flight; }
+    /// Cancellation requests don't have anything to deliver to
+    if (not d) { return; }
+    d->deliver(c.result, c.flags);
+    /// Multishot IOPs stay submitted until a CQE arrives without this flag
+    if (c.flags & IORING_CQE_F_MORE) { return; }
     if (d->is_outstanding) { std::erase(outstanding, d); }
     if (--d->iop_count == 0 and not d->iop_exists) { delete d; }
 }
+
+
+/// ## Cross-thread wake ups
+
+
+felspar::io::uring_warden::wake_read::wake_read(uring_warden &w)
+: ward{w}, event{::eventfd(0, EFD_CLOEXEC)} {
+    if (not event) {
+        throw felspar::stdexcept::system_error{
+                errno, std::system_category(), "eventfd"};
+    }
+}
+
+
+void felspar::io::uring_warden::wake_read::deliver(
+        int const result, std::uint32_t) {
+    armed = false;
+    /// After an error the read is tried again the next time the loop runs
+    if (result >= 0) { ward.ring->watch_wakeups(); }
+    ward.run_posted();
+}
+
+
+void felspar::io::uring_warden::impl::watch_wakeups() {
+    if (wake.armed) { return; }
+    auto *sqe = ::io_uring_get_sqe(&uring);
+    if (not sqe) {
+        submit();
+        sqe = ::io_uring_get_sqe(&uring);
+    }
+    if (not sqe) {
+        throw felspar::stdexcept::runtime_error{
+                "No SQE is available for the wake up read"};
+    }
+    ::io_uring_prep_read(
+            sqe, wake.event.native_handle(), &wake.count, sizeof(wake.count),
+            0);
+    ::io_uring_sqe_set_data(sqe, &wake);
+    wake.armed = true;
+}
+
+
+void felspar::io::uring_warden::do_wake() noexcept {
+    std::uint64_t const one = 1;
+    [[maybe_unused]] auto const written =
+            ::write(ring->wake.event.native_handle(), &one, sizeof(one));
+}
+
+
+/// ## Registered file descriptors
+
+
+auto felspar::io::uring_warden::register_fd(
+        socket_descriptor const fd, felspar::source_location const &loc)
+        -> fixed_fd {
+    auto const slot = ring->take_file_slot(fixed_file_slots, loc);
+    if (auto const ret =
+                ::io_uring_register_files_update(&ring->uring, slot, &fd, 1);
+        ret < 0) {
+        ring->free_file_slots.push_back(slot);
+        throw felspar::stdexcept::system_error{
+                -ret, std::system_category(), "io_uring_register_files_update",
+                loc};
+    }
+    return {this, slot};
+}
+
+
+void felspar::io::uring_warden::fixed_fd::reset() noexcept {
+    if (ward) { std::exchange(ward, nullptr)->ring->release_file_slot(index); }
+    index = -1;
+}
+
+
+auto felspar::io::uring_warden::impl::take_splice_pipe(
+        felspar::source_location const &loc) -> splice_pipe {
+    if (not splice_pipes.empty()) {
+        auto p = std::move(splice_pipes.back());
+        splice_pipes.pop_back();
+        return p;
+    }
+    /// A larger pipe means fewer splices for large files
+    constexpr int wanted = 1 << 20;
+    int fds[2] = {};
+    if (::pipe2(fds, O_CLOEXEC) != 0) {
+        throw felspar::stdexcept::system_error{
+                errno, std::system_category(), "Creating splice pipe", loc};
+    }
+    io::pipe ends{posix::fd{fds[0]}, posix::fd{fds[1]}};
+    auto capacity = ::fcntl(fds[1], F_SETPIPE_SZ, wanted);
+    if (capacity < 0) { capacity = ::fcntl(fds[1], F_GETPIPE_SZ); }
+    if (capacity < 0) {
+        throw felspar::stdexcept::system_error{
+                errno, std::system_category(), "Sizing splice pipe", loc};
+    }
+    return {std::move(ends), static_cast<std::size_t>(capacity)};
+}
+
+
+int felspar::io::uring_warden::impl::take_file_slot(
+        unsigned const slots, felspar::source_location const &loc) {
+    if (not file_slots) {
+        if (auto const ret = ::io_uring_register_files_sparse(&uring, slots);
+            ret < 0) {
+            throw felspar::stdexcept::system_error{
+                    -ret, std::system_category(),
+                    "io_uring_register_files_sparse", loc};
+        }
+        file_slots = slots;
+        free_file_slots.reserve(slots);
+        for (int slot = slots; slot--;) { free_file_slots.push_back(slot); }
+    }
+    if (free_file_slots.empty()) {
+        throw felspar::stdexcept::runtime_error{
+                "All of the registered file slots are in use", loc};
+    }
+    auto const slot = free_file_slots.back();
+    free_file_slots.pop_back();
+    return slot;
+}
+
+
+void felspar::io::uring_warden::impl::release_file_slot(int const slot) {
+    int const empty = -1;
+    ::io_uring_register_files_update(&uring, slot, &empty, 1);
+    free_file_slots.push_back(slot);
+}
+
+
+/// ## Registered buffers
+
+
+auto felspar::io::uring_warden::do_register_buffers(
+        std::span<std::span<std::byte> const> const buffers,
+        felspar::source_location const &loc) -> std::vector<registered_buffer> {
+    do_unregister_buffers();
+    std::vector<::iovec> iovecs;
+    iovecs.reserve(buffers.size());
+    for (auto const b : buffers) { iovecs.push_back({b.data(), b.size()}); }
+    if (auto const ret = ::io_uring_register_buffers(
+                &ring->uring, iovecs.data(), iovecs.size());
+        ret < 0) {
+        throw felspar::stdexcept::system_error{
+                -ret, std::system_category(), "io_uring_register_buffers",
+                loc};
+    }
+    ring->buffers_registered = true;
+    std::vector<registered_buffer> handles;
+    handles.reserve(buffers.size());
+    for (int index{}; auto const b : buffers) {
+        handles.emplace_back(b, index++);
+    }
+    return handles;
+}
+
+
+void felspar::io::uring_warden::do_unregister_buffers() {
+    if (std::exchange(ring->buffers_registered, false)) {
+        ::io_uring_unregister_buffers(&ring->uring);
+    }
+}
+
+
+/// ## `felspar::io::uring_warden::buffer_ring`
+
+
+felspar::io::uring_warden::buffer_ring::buffer_ring(
+        ::io_uring &u, buffer_pool::options const &o)
+: buffer_pool{o}, uring{u}, entries{std::bit_ceil(unsigned{o.buffers})} {
+    int error = {};
+    ring = ::io_uring_setup_buf_ring(&uring, entries, group, 0, &error);
+    if (not ring) {
+        throw felspar::stdexcept::system_error{
+                -error, std::system_category(), "io_uring_setup_buf_ring"};
+    }
+    int added = {};
+    while (auto const id = acquire()) {
+        auto const b = buffer(*id);
+        ::io_uring_buf_ring_add(
+                ring, b.data(), b.size(), *id,
+                ::io_uring_buf_ring_mask(entries), added++);
+    }
+    ::io_uring_buf_ring_advance(ring, added);
+}
+
+
+felspar::io::uring_warden::buffer_ring::~buffer_ring() {
+    ::io_uring_free_buf_ring(&uring, ring, entries, group);
+}
+
+
+void felspar::io::uring_warden::buffer_ring::recycle(
+        std::uint16_t const id) noexcept {
+    auto const b = buffer(id);
+    ::io_uring_buf_ring_add(
+            ring, b.data(), b.size(), id, ::io_uring_buf_ring_mask(entries), 0);
+    ::io_uring_buf_ring_advance(ring, 1);
+}
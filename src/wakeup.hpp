@@ -0,0 +1,94 @@
+#pragma once
+
+
+#include <felspar/exceptions.hpp>
+#include <felspar/io/warden.hpp>
+
+#include <array>
+
+#if __has_include(<sys/eventfd.h>)
+#include <sys/eventfd.h>
+#endif
+#if not defined(FELSPAR_WINSOCK2)
+#include <unistd.h>
+#endif
+
+
+namespace felspar::io {
+
+
+    /// ## Cross-thread wake up
+    /**
+     * Other threads signal the wake up and the warden sees its file descriptor
+     * become readable. This is an `eventfd` where there is one, and a pipe
+     * elsewhere.
+     */
+    class wakeup {
+#if __has_include(<sys/eventfd.h>)
+        posix::fd event;
+#else
+        io::pipe ends;
+#endif
+
+
+      public:
+        explicit wakeup(warden &ward) {
+#if __has_include(<sys/eventfd.h>)
+            event = posix::fd{::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+            if (not event) {
+                throw felspar::stdexcept::system_error{
+                        errno, std::system_category(), "eventfd"};
+            }
+            static_cast<void>(ward);
+#else
+            ends = ward.create_pipe();
+#endif
+        }
+
+        /// The file descriptor to wait on
+        socket_descriptor native_handle() const noexcept {
+#if __has_include(<sys/eventfd.h>)
+            return event.native_handle();
+#else
+            return ends.read.native_handle();
+#endif
+        }
+
+        /// Safe to call from any thread
+        void signal() noexcept {
+#if __has_include(<sys/eventfd.h>)
+            std::uint64_t const one = 1;
+            [[maybe_unused]] auto const w =
+                    ::write(event.native_handle(), &one, sizeof(one));
+#elif defined(FELSPAR_WINSOCK2)
+            char const b{};
+            ::send(ends.write.native_handle(), &b, 1, 0);
+#else
+            std::byte const b{};
+            [[maybe_unused]] auto const w =
+                    ::write(ends.write.native_handle(), &b, 1);
+#endif
+        }
+
+        /// Clear the signal, from the warden's thread
+        void drain() noexcept {
+#if __has_include(<sys/eventfd.h>)
+            std::uint64_t count;
+            [[maybe_unused]] auto const r =
+                    ::read(event.native_handle(), &count, sizeof(count));
+#elif defined(FELSPAR_WINSOCK2)
+            std::array<char, 64> buffer;
+            while (::recv(ends.read.native_handle(), buffer.data(),
+                          static_cast<int>(buffer.size()), 0)
+                   > 0) {}
+#else
+            std::array<std::byte, 64> buffer;
+            while (::read(ends.read.native_handle(), buffer.data(),
+                          buffer.size())
+                   > 0) {}
+#endif
+        }
+    };
+
+
+}
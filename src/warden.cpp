@@ -6,6 +6,12 @@
 #endif
 
 
+felspar::io::warden::~warden() {
+    auto *p = inbox.exchange(nullptr, std::memory_order_acquire);
+    while (p) { delete std::exchange(p, p->next); }
+}
+
+
 felspar::posix::fd felspar::io::warden::create_socket(
         int domain,
         int type,
@@ -23,6 +29,71 @@ felspar::posix::fd felspar::io::warden::create_socket(
 }
 
 
+auto felspar::io::warden::do_register_buffers(
+        std::span<std::span<std::byte> const> const buffers,
+        felspar::source_location const &) -> std::vector<registered_buffer> {
+    std::vector<registered_buffer> handles;
+    handles.reserve(buffers.size());
+    for (auto const b : buffers) { handles.emplace_back(b, -1); }
+    return handles;
+}
+
+
+auto felspar::io::warden::do_read_some_v(
+        socket_descriptor const fd,
+        std::span<std::span<std::byte> const> const buffers,
+        std::optional<std::chrono::nanoseconds> const timeout,
+        felspar::source_location const &loc) -> iop<std::size_t> {
+    for (auto const b : buffers) {
+        if (not b.empty()) { return do_read_some(fd, b, timeout, loc); }
+    }
+    return do_read_some(fd, {}, timeout, loc);
+}
+auto felspar::io::warden::do_write_some_v(
+        socket_descriptor const fd,
+        std::span<std::span<std::byte const> const> const buffers,
+        std::optional<std::chrono::nanoseconds> const timeout,
+        felspar::source_location const &loc) -> iop<std::size_t> {
+    for (auto const b : buffers) {
+        if (not b.empty()) { return do_write_some(fd, b, timeout, loc); }
+    }
+    return do_write_some(fd, {}, timeout, loc);
+}
+
+
+/**
+ * Posted functions are pushed onto a lock-free stack. Only the push that finds
+ * the stack empty needs to wake the loop, as the loop takes everything at once.
+ */
+void felspar::io::warden::do_post(std::function<void()> f) {
+    auto *const p = new posted{std::move(f), nullptr};
+    auto *head = inbox.load(std::memory_order_relaxed);
+    do {
+        p->next = head;
+    } while (not inbox.compare_exchange_weak(
+            head, p, std::memory_order_release, std::memory_order_relaxed));
+    /// Once pushed the loop may already have run and deleted `p`
+    if (not head) { do_wake(); }
+}
+bool felspar::io::warden::run_posted() noexcept {
+    auto *p = inbox.exchange(nullptr, std::memory_order_acquire);
+    if (not p) { return false; }
+    /// The stack has the most recent post first
+    posted *in_order = nullptr;
+    while (p) {
+        auto *const next = p->next;
+        p->next = std::exchange(in_order, p);
+        p = next;
+    }
+    while (in_order) {
+        std::unique_ptr<posted> const run{
+                std::exchange(in_order, in_order->next)};
+        run->function();
+    }
+    return true;
+}
+
+
 auto felspar::io::warden::create_pipe(felspar::source_location const &loc)
         -> pipe {
 #ifdef FELSPAR_WINSOCK2
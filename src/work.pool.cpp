@@ -0,0 +1,282 @@
+#include <felspar/io/work.pool.hpp>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+
+
+namespace {
+
+
+    /**
+     * Chase and Lev's work stealing deque with a fixed capacity. Only the
+     * owning worker pushes and pops at the bottom, any thread may steal from
+     * the top.
+     */
+    class stealing_deque {
+        static constexpr std::int64_t capacity = 1024;
+        std::array<std::atomic<void *>, capacity> slots = {};
+        alignas(64) std::atomic<std::int64_t> top = {};
+        alignas(64) std::atomic<std::int64_t> bottom = {};
+
+
+      public:
+        bool push(felspar::coro::coroutine_handle<> const h) noexcept {
+            auto const b = bottom.load(std::memory_order_relaxed);
+            auto const t = top.load(std::memory_order_acquire);
+            if (b - t >= capacity) { return false; }
+            slots[b % capacity].store(h.address(), std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_release);
+            return true;
+        }
+
+        felspar::coro::coroutine_handle<> pop() noexcept {
+            auto const b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto t = top.load(std::memory_order_relaxed);
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return {};
+            }
+            void *address = slots[b % capacity].load(std::memory_order_relaxed);
+            if (t == b) {
+                /// The last one, so race any thieves for it
+                if (not top.compare_exchange_strong(
+                            t, t + 1, std::memory_order_seq_cst,
+                            std::memory_order_relaxed)) {
+                    address = nullptr;
+                }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return felspar::coro::coroutine_handle<>::from_address(address);
+        }
+
+        felspar::coro::coroutine_handle<> steal() noexcept {
+            auto t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto const b = bottom.load(std::memory_order_acquire);
+            if (t >= b) { return {}; }
+            void *const address =
+                    slots[t % capacity].load(std::memory_order_relaxed);
+            if (top.compare_exchange_strong(
+                        t, t + 1, std::memory_order_seq_cst,
+                        std::memory_order_relaxed)) {
+                return felspar::coro::coroutine_handle<>::from_address(
+                        address);
+            } else {
+                return {};
+            }
+        }
+    };
+
+
+}
+
+
+class felspar::io::work_pool::worker {
+    struct submitted {
+        felspar::coro::coroutine_handle<> handle;
+        submitted *next;
+    };
+
+    stealing_deque local;
+    /// Submissions from other threads, most recent first
+    std::atomic<submitted *> inbox = {};
+    /// Taken from the inbox but not yet in the full deque
+    std::deque<felspar::coro::coroutine_handle<>> overflow;
+    std::atomic<std::uint32_t> signal = {};
+
+
+  public:
+    worker(work_pool &p, std::size_t const i) : pool{p}, index{i} {}
+    ~worker() {
+        auto *p = inbox.exchange(nullptr, std::memory_order_acquire);
+        while (p) { delete std::exchange(p, p->next); }
+    }
+
+    work_pool &pool;
+    std::size_t const index;
+    std::atomic<bool> asleep = false;
+    std::atomic<std::size_t> stolen = {};
+    std::thread thread;
+
+    static thread_local worker *current;
+
+
+    /// Called from any thread
+    void submit(felspar::coro::coroutine_handle<> const h) {
+        if (current == this) {
+            if (not local.push(h)) { overflow.push_back(h); }
+            pool.wake_idle(this);
+            return;
+        }
+        auto *const s = new submitted{h, nullptr};
+        auto *head = inbox.load(std::memory_order_relaxed);
+        do {
+            s->next = head;
+        } while (not inbox.compare_exchange_weak(
+                head, s, std::memory_order_release,
+                std::memory_order_relaxed));
+        /// Once pushed `s` belongs to the worker, so only `head` can be used
+        if (not head) { wake(); }
+    }
+    void wake() noexcept {
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+    }
+
+
+    /// The worker thread's loop
+    void run() {
+        current = this;
+        while (true) {
+            if (auto h = find_work(); h) {
+                h.resume();
+                continue;
+            }
+            /**
+             * Anything submitted after the signal is read will change it, so
+             * the wait can't miss it.
+             */
+            auto const seen = signal.load(std::memory_order_acquire);
+            asleep.store(true);
+            if (auto h = find_work(); h) {
+                asleep.store(false);
+                h.resume();
+            } else if (pool.stopping.load(std::memory_order_acquire)) {
+                asleep.store(false);
+                return;
+            } else {
+                signal.wait(seen, std::memory_order_acquire);
+                asleep.store(false);
+            }
+        }
+    }
+
+
+  private:
+    felspar::coro::coroutine_handle<> find_work() {
+        if (auto h = local.pop(); h) { return h; }
+        if (refill()) {
+            pool.wake_idle(this);
+            return local.pop();
+        }
+        for (std::size_t offset{1}; offset < pool.workers.size(); ++offset) {
+            auto &victim =
+                    *pool.workers[(index + offset) % pool.workers.size()];
+            if (auto h = victim.local.steal(); h) {
+                stolen.fetch_add(1, std::memory_order_relaxed);
+                return h;
+            }
+        }
+        /**
+         * A worker that is busy with a long running coroutine doesn't move
+         * its inbox into its deque, so its submissions are taken whole.
+         */
+        for (std::size_t offset{1}; offset < pool.workers.size(); ++offset) {
+            auto &victim =
+                    *pool.workers[(index + offset) % pool.workers.size()];
+            if (not victim.inbox.load(std::memory_order_relaxed)) { continue; }
+            if (auto const taken = take(victim.inbox.exchange(
+                        nullptr, std::memory_order_acquire))) {
+                stolen.fetch_add(taken, std::memory_order_relaxed);
+                refill();
+                pool.wake_idle(this);
+                return local.pop();
+            }
+        }
+        return {};
+    }
+
+    /// Add submissions to the overflow, oldest first, returning how many
+    std::size_t take(submitted *p) {
+        auto const at = overflow.size();
+        std::size_t taken{};
+        while (p) {
+            std::unique_ptr<submitted> const s{std::exchange(p, p->next)};
+            overflow.insert(overflow.begin() + at, s->handle);
+            ++taken;
+        }
+        return taken;
+    }
+
+    /// Move submissions into the deque where other workers can steal them
+    bool refill() {
+        take(inbox.exchange(nullptr, std::memory_order_acquire));
+        bool moved = false;
+        while (not overflow.empty() and local.push(overflow.front())) {
+            overflow.pop_front();
+            moved = true;
+        }
+        return moved;
+    }
+};
+
+
+thread_local felspar::io::work_pool::worker
+        *felspar::io::work_pool::worker::current = nullptr;
+
+
+felspar::io::work_pool::work_pool(std::size_t const threads) {
+    auto const count = std::max<std::size_t>(threads, 1);
+    workers.reserve(count);
+    for (std::size_t index{}; index < count; ++index) {
+        workers.push_back(std::make_unique<worker>(*this, index));
+    }
+    for (auto &w : workers) {
+        w->thread = std::thread{[w = w.get()]() { w->run(); }};
+    }
+}
+
+
+felspar::io::work_pool::~work_pool() {
+    stopping.store(true, std::memory_order_release);
+    for (auto &w : workers) { w->wake(); }
+    /// Workers steal from each other, so they must all stop before any go
+    for (auto &w : workers) { w->thread.join(); }
+}
+
+
+std::size_t felspar::io::work_pool::steals() const noexcept {
+    std::size_t count{};
+    for (auto const &w : workers) {
+        count += w->stolen.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+
+void felspar::io::work_pool::submit(felspar::coro::coroutine_handle<> const h) {
+    if (worker::current and &worker::current->pool == this) {
+        worker::current->submit(h);
+        return;
+    }
+    /// Prefer a worker that is asleep, otherwise go round them all in turn
+    auto const start = next_worker.fetch_add(1, std::memory_order_relaxed);
+    for (std::size_t offset{}; offset < workers.size(); ++offset) {
+        auto &w = *workers[(start + offset) % workers.size()];
+        if (w.asleep.load(std::memory_order_relaxed)) {
+            w.submit(h);
+            return;
+        }
+    }
+    workers[start % workers.size()]->submit(h);
+}
+
+
+/// Wake a sleeping worker so it can steal from one that has too much
+void felspar::io::work_pool::wake_idle(worker const *const busy) noexcept {
+    /**
+     * The work was made visible before `asleep` is read here, and a worker
+     * sets `asleep` before looking for work again. Without a full fence
+     * both could miss the other's store, leaving the work unnoticed.
+     */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (auto &w : workers) {
+        if (w.get() != busy and w->asleep.load(std::memory_order_relaxed)) {
+            w->wake();
+            return;
+        }
+    }
+}
@@ -0,0 +1 @@
+#include <felspar/io/buffer.pool.hpp>
@@ -0,0 +1 @@
+#include <felspar/io/buffered.writer.hpp>
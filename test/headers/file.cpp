@@ -0,0 +1 @@
+#include <felspar/io/file.hpp>
@@ -0,0 +1 @@
+#include <felspar/io/frame.pool.hpp>
@@ -0,0 +1 @@
+#include <felspar/io/registered.buffer.hpp>
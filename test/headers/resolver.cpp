@@ -0,0 +1 @@
+#include <felspar/io/resolver.hpp>
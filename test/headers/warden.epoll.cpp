@@ -0,0 +1 @@
+#include <felspar/io/warden.epoll.hpp>
@@ -0,0 +1 @@
+#include <felspar/io/warden.pool.hpp>
@@ -0,0 +1 @@
+#include <felspar/io/work.pool.hpp>
@@ -0,0 +1,77 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("accept");
+
+
+    /**
+     * All of the connections are made before the accept stream is asked for
+     * any of them, so they must all be delivered from a single wait. Some
+     * more are then left un-accepted when the stream is destroyed.
+     */
+    felspar::io::warden::task<std::size_t>
+            burst(felspar::io::warden &ward, std::uint16_t port) {
+        auto fd = ward.create_socket(AF_INET, SOCK_STREAM, 0);
+        felspar::posix::set_reuse_port(fd);
+        felspar::posix::bind_to_any_address(fd, port);
+        felspar::posix::listen(fd, 64);
+
+        sockaddr_in in;
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        std::vector<felspar::posix::fd> clients;
+        auto const connect = [&]() -> felspar::io::iop<void> {
+            clients.push_back(ward.create_socket(AF_INET, SOCK_STREAM, 0));
+            return ward.connect(
+                    clients.back(), reinterpret_cast<sockaddr const *>(&in),
+                    sizeof(in), 20ms);
+        };
+
+        std::size_t accepted{};
+        {
+            auto acceptor = felspar::io::accept(ward, fd);
+            for (std::size_t index{}; index < 20; ++index) {
+                co_await connect();
+            }
+            while (accepted < 20) {
+                auto cnx = co_await acceptor.next();
+                if (not cnx) { break; }
+                felspar::posix::fd{*cnx};
+                ++accepted;
+            }
+            for (std::size_t index{}; index < 5; ++index) {
+                co_await connect();
+            }
+        }
+        co_await ward.sleep(5ms);
+        co_return accepted;
+    }
+
+
+    auto const bp = suite.test("burst/poll", [](auto check) {
+        felspar::io::poll_warden ward;
+        check(ward.run(burst, 5553)) == 20u;
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const be = suite.test("burst/epoll", [](auto check) {
+        felspar::io::epoll_warden ward;
+        check(ward.run(burst, 5554)) == 20u;
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const bu = suite.test("burst/uring", [](auto check) {
+        felspar::io::uring_warden ward;
+        check(ward.run(burst, 5552)) == 20u;
+    });
+#endif
+
+
+}
@@ -1,12 +1,31 @@
 #include <felspar/coro/eager.hpp>
+#include <felspar/coro/starter.hpp>
 #include <felspar/io.hpp>
 #include <felspar/memory/fixed-pool.pmr.hpp>
 #include <felspar/test.hpp>
 
+#include <cstdlib>
+
 
 using namespace std::literals;
 
 
+namespace {
+    /// Counts every use of the global `operator new`
+    std::size_t heap_allocations{};
+}
+void *operator new(std::size_t const bytes) {
+    ++heap_allocations;
+    if (auto *const p = std::malloc(bytes ? bytes : 1)) {
+        return p;
+    } else {
+        throw std::bad_alloc{};
+    }
+}
+void operator delete(void *const p) noexcept { std::free(p); }
+void operator delete(void *const p, std::size_t) noexcept { std::free(p); }
+
+
 namespace {
 
 
@@ -63,4 +82,84 @@ namespace {
     });
 
 
+    /**
+     * Once the warden has warmed up, reads and writes shouldn't need to go
+     * to the heap for their completions. Waiting for the pipe to become
+     * readable makes sure that the loop is involved each time around.
+     */
+    felspar::io::warden::task<std::size_t>
+            steady_state(felspar::io::warden &ward) {
+        auto pipe = ward.create_pipe();
+        std::array<std::byte, 16> out{}, in{};
+        std::size_t before{};
+        for (std::size_t index{}; index < 100; ++index) {
+            if (index == 10) { before = heap_allocations; }
+            co_await ward.write_some(pipe.write, out, 20ms);
+            co_await ward.read_ready(pipe.read, 20ms);
+            co_await ward.read_some(pipe.read, in, 20ms);
+        }
+        co_return heap_allocations - before;
+    }
+    auto const ssp = suite.test("steady-state/poll", [](auto check) {
+        felspar::io::poll_warden ward;
+        check(ward.run(steady_state)) == 0u;
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const sse = suite.test("steady-state/epoll", [](auto check) {
+        felspar::io::epoll_warden ward;
+        check(ward.run(steady_state)) == 0u;
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const ssu = suite.test("steady-state/uring", [](auto check) {
+        felspar::io::uring_warden ward;
+        check(ward.run(steady_state)) == 0u;
+    });
+#endif
+
+
+    /**
+     * With a frame pool the sleepers of the later rounds should re-use the
+     * frames of the first round, and no frame is left allocated once the
+     * warden has finished running.
+     */
+    felspar::io::warden::task<void> rounds(felspar::io::warden &ward) {
+        for (std::size_t round{}; round < 4; ++round) {
+            felspar::io::warden::starter<void> co;
+            for (std::size_t index{}; index < 10; ++index) {
+                co.post(sleeper, std::ref(ward));
+            }
+            co_await ward.sleep(50ms);
+        }
+    }
+    template<typename Warden>
+    void check_frame_pool(auto check) {
+        Warden unpooled;
+        unpooled.run(rounds);
+        check(unpooled.frame_statistics().hits) == 0u;
+        check(unpooled.frame_statistics().misses) == 0u;
+
+        Warden ward{felspar::io::frame_pool::options{}};
+        ward.run(rounds);
+        auto const stats = ward.frame_statistics();
+        check(stats.hits + stats.misses) == 41u;
+        check(stats.misses) <= 2u;
+        check(stats.in_use) == 0u;
+        check(stats.high_water) == 11u;
+    }
+    auto const fpp = suite.test("frame-pool/poll", [](auto check) {
+        check_frame_pool<felspar::io::poll_warden>(check);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const fpe = suite.test("frame-pool/epoll", [](auto check) {
+        check_frame_pool<felspar::io::epoll_warden>(check);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const fpu = suite.test("frame-pool/uring", [](auto check) {
+        check_frame_pool<felspar::io::uring_warden>(check);
+    });
+#endif
+
+
 }
@@ -91,6 +91,14 @@ namespace {
         co.post(echo_server, ward, 5543);
         ward.run(echo_client, 5543);
     });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const te = suite.test("echo/epoll", []() {
+        felspar::io::epoll_warden ward;
+        felspar::io::warden::eager<> co;
+        co.post(echo_server, ward, 5549);
+        ward.run(echo_client, 5549);
+    });
+#endif
 #ifdef FELSPAR_ENABLE_IO_URING
     auto const tu = suite.test("echo/uring", []() {
         felspar::io::uring_warden ward{10};
@@ -0,0 +1,139 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("buffered_writer");
+
+
+    felspar::io::warden::task<std::string>
+            drain(felspar::io::warden &ward,
+                  felspar::posix::fd const &fd,
+                  std::size_t const expected) {
+        std::string received;
+        std::array<char, 256> buffer;
+        while (received.size() < expected) {
+            auto const bytes = co_await ward.read_some(
+                    fd, std::as_writable_bytes(std::span{buffer}), 20ms);
+            received.append(buffer.data(), bytes);
+        }
+        co_return received;
+    }
+
+
+    /// Many small writes in one loop iteration go out together
+    felspar::io::warden::task<void> coalesce(felspar::io::warden &ward) {
+        felspar::test::injected check;
+        auto pipe = ward.create_pipe();
+
+        felspar::io::buffered_writer writer{ward, pipe.write};
+        for (std::size_t index{}; index < 100; ++index) {
+            co_await writer.write("ab");
+        }
+        check(writer.buffered()) == 200u;
+        check((co_await drain(ward, pipe.read, 200)).size()) == 200u;
+        check(writer.buffered()) == 0u;
+        check(writer.counters().writes) == 100u;
+        check(writer.counters().flushes) == 1u;
+    }
+    auto const cp = suite.test("coalesce/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(coalesce);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const ce = suite.test("coalesce/epoll", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(coalesce);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const cu = suite.test("coalesce/uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(coalesce);
+    });
+#endif
+
+
+    /// A corked writer only sends when full or when it is uncorked
+    felspar::io::warden::task<void> cork(felspar::io::warden &ward) {
+        felspar::test::injected check;
+        auto pipe = ward.create_pipe();
+
+        felspar::io::buffered_writer writer{
+                ward, pipe.write, {.flush_threshold = 8}};
+        writer.cork();
+        co_await writer.write("abc");
+        co_await ward.sleep(5ms);
+        check(writer.buffered()) == 3u;
+        co_await writer.write("defgh");
+        check(writer.buffered()) == 0u;
+        co_await writer.write("ij");
+        co_await writer.uncork();
+        check(co_await drain(ward, pipe.read, 10)) == "abcdefghij";
+        check(writer.counters().flushes) == 2u;
+    }
+    auto const kp = suite.test("cork/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(cork);
+    });
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const ku = suite.test("cork/uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(cork);
+    });
+#endif
+
+
+    /// Writes from two coroutines at once are never mixed up
+    constexpr std::size_t chunk_size = 1000, chunks = 100;
+    felspar::io::warden::task<void> write_chunks(
+            felspar::io::warden &,
+            felspar::io::buffered_writer<felspar::posix::fd> &writer,
+            char const c) {
+        std::string const chunk(chunk_size, c);
+        for (std::size_t index{}; index < chunks; ++index) {
+            co_await writer.write(chunk);
+        }
+        co_await writer.flush();
+    }
+    felspar::io::warden::task<void> concurrent(felspar::io::warden &ward) {
+        felspar::test::injected check;
+        auto pipe = ward.create_pipe();
+
+        felspar::io::buffered_writer writer{
+                ward, pipe.write, {.flush_threshold = chunk_size}};
+        felspar::io::warden::starter<void> writers;
+        writers.post(write_chunks, std::ref(ward), std::ref(writer), 'a');
+        writers.post(write_chunks, std::ref(ward), std::ref(writer), 'b');
+        auto const received =
+                co_await drain(ward, pipe.read, 2 * chunks * chunk_size);
+        co_await writers.wait_for_all();
+
+        check(received.size()) == 2 * chunks * chunk_size;
+        std::size_t as{};
+        for (std::size_t at{}; at < received.size(); at += chunk_size) {
+            auto const block =
+                    std::string_view{received}.substr(at, chunk_size);
+            check(block.find_first_not_of(block[0])) == std::string_view::npos;
+            if (block[0] == 'a') { ++as; }
+        }
+        check(as) == chunks;
+    }
+    auto const np = suite.test("concurrent/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(concurrent);
+    });
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const nu = suite.test("concurrent/uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(concurrent);
+    });
+#endif
+
+
+}
@@ -25,6 +25,12 @@ namespace {
         felspar::io::poll_warden ward;
         ward.run(starter);
     });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const ec = suite.test("epoll/cancel", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(starter);
+    });
+#endif
 #ifdef FELSPAR_ENABLE_IO_URING
     auto const uc = suite.test("io_uring/cancel", []() {
         felspar::io::uring_warden ward{5};
@@ -33,4 +39,69 @@ namespace {
 #endif
 
 
+#ifdef FELSPAR_ENABLE_IO_URING
+    /// The abandoned read is cancelled in the kernel rather than left waiting
+    felspar::io::warden::task<void>
+            reader(felspar::io::warden &ward, felspar::posix::fd const &fd) {
+        std::array<std::byte, 16> buffer;
+        co_await ward.read_some(fd, buffer);
+    }
+    auto const ua = suite.test("io_uring/abandon", [](auto check) {
+        felspar::io::uring_warden ward;
+        ward.run(
+                +[](felspar::io::warden &ward)
+                        -> felspar::io::warden::task<void> {
+                    auto pipe = ward.create_pipe();
+                    {
+                        felspar::io::warden::starter<void> start;
+                        start.post(
+                                reader, std::ref(ward), std::cref(pipe.read));
+                        co_await ward.sleep(5ms);
+                    }
+                    co_await ward.sleep(5ms);
+                });
+        check(ward.ring_statistics().cancellations) == 1u;
+        check(ward.ring_statistics().in_flight) == 0u;
+    });
+#endif
+
+
+    /// Every IOP waiting on the file descriptor fails
+    felspar::io::warden::task<void> cancel_all(felspar::io::warden &ward) {
+        felspar::test::injected check;
+        auto pipe = ward.create_pipe();
+
+        felspar::io::warden::eager<std::error_code> reading;
+        reading.post(
+                +[](felspar::io::warden &ward, felspar::posix::fd const &fd)
+                        -> felspar::io::warden::task<std::error_code> {
+                    std::array<std::byte, 16> buffer;
+                    auto const read = co_await felspar::io::ec{
+                            ward.read_some(fd, buffer, 100ms)};
+                    co_return read.error;
+                },
+                std::ref(ward), std::cref(pipe.read));
+        co_await ward.sleep(5ms);
+        ward.cancel_all(pipe.read);
+        check(co_await std::move(reading).release())
+                == std::error_code{ECANCELED, std::system_category()};
+    }
+    auto const pa = suite.test("poll/cancel_all", []() {
+        felspar::io::poll_warden ward;
+        ward.run(cancel_all);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const ea = suite.test("epoll/cancel_all", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(cancel_all);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const uca = suite.test("io_uring/cancel_all", []() {
+        felspar::io::uring_warden ward;
+        ward.run(cancel_all);
+    });
+#endif
+
+
 }
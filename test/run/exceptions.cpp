@@ -42,6 +42,34 @@ namespace {
     });
 
 
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const wree = suite.test("early epoll", [](auto check) {
+        check([&]() {
+            felspar::io::epoll_warden ward;
+            ward.run(
+                    +[](felspar::io::warden &)
+                            -> felspar::io::warden::task<void> {
+                        always_throw();
+                        co_return;
+                    });
+        }).template throws_type<felspar::stdexcept::runtime_error>();
+    });
+
+
+    auto const wrle = suite.test("late epoll", [](auto check) {
+        check([&]() {
+            felspar::io::epoll_warden ward;
+            ward.run(
+                    +[](felspar::io::warden &ward)
+                            -> felspar::io::warden::task<void> {
+                        co_await ward.sleep(10ms);
+                        always_throw();
+                    });
+        }).template throws_type<felspar::stdexcept::runtime_error>();
+    });
+#endif
+
+
 #ifdef FELSPAR_ENABLE_IO_URING
     auto const wreu = suite.test("early io_uring", [](auto check) {
         check([&]() {
@@ -0,0 +1,73 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+#include <fcntl.h>
+#include <filesystem>
+#include <unistd.h>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("files");
+
+
+    felspar::io::warden::task<void>
+            round_trip(felspar::io::warden &ward, std::string const name) {
+        felspar::test::injected check;
+        auto const path = std::filesystem::temp_directory_path()
+                / ("felspar-io-files-" + name + "-"
+                   + std::to_string(::getpid()));
+
+        felspar::posix::fd file{co_await ward.open(
+                path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600)};
+        check(file.native_handle()) >= 0;
+
+        auto const out = std::as_bytes(std::span{"positional"sv});
+        check(co_await ward.write_at(file, out, 100)) == out.size();
+        co_await ward.fdatasync(file);
+        co_await ward.fsync(file);
+
+        auto const by_fd = co_await ward.stat(file);
+        check(by_fd.size) == 100u + out.size();
+        auto const by_path = co_await ward.stat(path.c_str());
+        check(by_path.inode) == by_fd.inode;
+        check(by_path.links) == 1u;
+
+        std::array<std::byte, 6> in;
+        check(co_await ward.read_at(file, in, 104)) == in.size();
+        check(std::string_view{
+                reinterpret_cast<char const *>(in.data()), in.size()})
+                == "tional";
+        check(co_await ward.read_at(file, in, 200)) == 0u;
+
+        std::filesystem::remove(path);
+        auto const missing =
+                co_await felspar::io::ec{ward.open(path.c_str(), O_RDONLY)};
+        check(missing.error)
+                == std::error_code{ENOENT, std::system_category()};
+    }
+
+
+    auto const poll = suite.test("poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(round_trip, "poll");
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const epoll = suite.test("epoll", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(round_trip, "epoll");
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const uring = suite.test("uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(round_trip, "uring");
+    });
+#endif
+
+
+}
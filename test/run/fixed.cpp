@@ -0,0 +1,116 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("fixed");
+
+
+    /// Registered buffers are written and read through a pipe
+    felspar::io::warden::task<void> buffers(felspar::io::warden &ward) {
+        felspar::test::injected check;
+
+        std::array<std::byte, 64> out{}, in{};
+        out[0] = std::byte{1};
+        out[63] = std::byte{64};
+        std::array<std::span<std::byte>, 2> memory{out, in};
+        auto const handles = ward.register_buffers(memory);
+        check(handles.size()) == 2u;
+
+        auto pipe = ward.create_pipe();
+        check(co_await ward.write_fixed(pipe.write, handles[0], 20ms)) == 64u;
+        check(co_await ward.read_fixed(pipe.read, handles[1].first(32), 20ms))
+                == 32u;
+        check(co_await ward.read_fixed(
+                pipe.read, handles[1].subspan(32), 20ms))
+                == 32u;
+        check(in[0]) == std::byte{1};
+        check(in[63]) == std::byte{64};
+        ward.unregister_buffers();
+    }
+    auto const bp = suite.test("buffers/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(buffers);
+    });
+
+
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const bu = suite.test("buffers/uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(buffers);
+    });
+
+
+    /// Both ends of the pipe are registered and then closed
+    auto const pipe = suite.test("pipe", []() {
+        felspar::io::uring_warden ward;
+        ward.run(
+                +[](felspar::io::warden &w) -> felspar::io::warden::task<void> {
+                    felspar::test::injected check;
+                    auto &ward = static_cast<felspar::io::uring_warden &>(w);
+
+                    auto pipe = ward.create_pipe();
+                    auto read = ward.register_fd(pipe.read);
+                    auto write = ward.register_fd(pipe.write);
+                    pipe = {};
+
+                    std::array<std::byte, 3> out{
+                            std::byte{1}, std::byte{2}, std::byte{3}},
+                            in{};
+                    check(co_await ward.write_some(write, out, 20ms)) == 3u;
+                    check(co_await ward.read_some(read, in, 20ms)) == 3u;
+                    check(in[2]) == std::byte{3};
+                });
+    });
+
+
+    /// The accepted connection only exists in the file table
+    auto const direct = suite.test("accept_direct", []() {
+        felspar::io::uring_warden ward;
+        ward.run(
+                +[](felspar::io::warden &w) -> felspar::io::warden::task<void> {
+                    felspar::test::injected check;
+                    auto &ward = static_cast<felspar::io::uring_warden &>(w);
+                    constexpr std::uint16_t port = 5560;
+
+                    auto listener = ward.create_tcp_socket();
+                    felspar::posix::set_reuse_port(listener);
+                    felspar::posix::bind_to_any_address(listener, port);
+                    felspar::posix::listen(listener, 64);
+                    auto fixed_listener = ward.register_fd(listener);
+
+                    sockaddr_in in;
+                    in.sin_family = AF_INET;
+                    in.sin_port = htons(port);
+                    in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                    auto client = ward.create_tcp_socket();
+                    co_await ward.connect(
+                            client, reinterpret_cast<sockaddr const *>(&in),
+                            sizeof(in), 20ms);
+
+                    auto cnx = co_await ward.accept_direct(listener, 20ms);
+                    check(cnx).is_truthy();
+                    std::array<std::byte, 2> out{std::byte{4}, std::byte{5}},
+                            buffer{};
+                    check(co_await ward.write_some(cnx, out, 20ms)) == 2u;
+                    check(co_await ward.read_some(client, buffer, 20ms)) == 2u;
+                    check(buffer[1]) == std::byte{5};
+
+                    auto other = ward.create_tcp_socket();
+                    co_await ward.connect(
+                            other, reinterpret_cast<sockaddr const *>(&in),
+                            sizeof(in), 20ms);
+                    auto second = co_await ward.accept(fixed_listener, 20ms);
+                    check(second) >= 0;
+                    felspar::posix::fd{second};
+                });
+    });
+#endif
+
+
+}
@@ -0,0 +1,122 @@
+#include <felspar/io.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/test.hpp>
+
+#include <atomic>
+#include <thread>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("offload");
+
+
+    /// The function runs on another thread and the result comes back home
+    felspar::io::warden::task<void>
+            hop(felspar::io::warden &, felspar::io::poll_warden &ward) {
+        felspar::test::injected check;
+        auto const home = std::this_thread::get_id();
+        auto const away = co_await ward.offload(
+                []() { return std::this_thread::get_id(); });
+        check(away) != home;
+        check(std::this_thread::get_id()) == home;
+        co_await ward.offload([]() {});
+        check(std::this_thread::get_id()) == home;
+    }
+    auto const ph = suite.test("poll/hop", []() {
+        felspar::io::poll_warden ward;
+        ward.run(hop, std::ref(ward));
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const eh = suite.test("epoll/hop", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(hop, std::ref(ward));
+    });
+#endif
+
+
+    felspar::io::warden::task<void>
+            failing(felspar::io::warden &, felspar::io::poll_warden &ward) {
+        co_await ward.offload([]() -> int {
+            throw felspar::stdexcept::runtime_error{"Offloaded failure"};
+        });
+    }
+    auto const pf = suite.test("poll/throws", [](auto check) {
+        felspar::io::poll_warden ward;
+        check([&]() {
+            ward.run(failing, std::ref(ward));
+        }).template throws_type<felspar::stdexcept::runtime_error>();
+    });
+
+
+    /// Blocking calls run side by side, but never on more than the limit
+    struct concurrency {
+        std::atomic<std::size_t> running = {}, most = {};
+    };
+    felspar::io::warden::task<void> block(
+            felspar::io::warden &,
+            felspar::io::poll_warden &ward,
+            concurrency &c) {
+        co_await ward.offload([&c]() {
+            auto const now = ++c.running;
+            auto seen = c.most.load();
+            while (now > seen and not c.most.compare_exchange_weak(seen, now)) {
+            }
+            std::this_thread::sleep_for(10ms);
+            --c.running;
+        });
+    }
+    felspar::io::warden::task<std::size_t>
+            bounded(felspar::io::warden &w, felspar::io::poll_warden &ward) {
+        concurrency c;
+        felspar::io::warden::starter<void> blocking;
+        for (std::size_t index{}; index < 16; ++index) {
+            blocking.post(block, std::ref(w), std::ref(ward), std::ref(c));
+        }
+        co_await blocking.wait_for_all();
+        co_return c.most.load();
+    }
+    auto const pb = suite.test("poll/bounded", [](auto check) {
+        felspar::io::poll_warden ward;
+        ward.offload_threads = 3;
+        auto const most = ward.run(bounded, std::ref(ward));
+        check(most) > 1u;
+        check(most) <= 3u;
+    });
+
+
+    /// The coroutine is destroyed while its call is still running
+    felspar::io::warden::task<void>
+            abandon(felspar::io::warden &w, felspar::io::poll_warden &ward) {
+        felspar::test::injected check;
+        std::atomic<bool> finished{false};
+        {
+            felspar::io::warden::starter<void> abandoned;
+            abandoned.post(
+                    +[](felspar::io::warden &,
+                        felspar::io::poll_warden &ward,
+                        std::atomic<bool> &finished)
+                            -> felspar::io::warden::task<void> {
+                        co_await ward.offload([&finished]() {
+                            std::this_thread::sleep_for(20ms);
+                            finished = true;
+                        });
+                    },
+                    std::ref(w), std::ref(ward), std::ref(finished));
+            co_await w.sleep(5ms);
+        }
+        co_await w.sleep(40ms);
+        check(finished.load()) == true;
+        check(co_await ward.offload([]() { return 42; })) == 42;
+    }
+    auto const pa = suite.test("poll/abandon", []() {
+        felspar::io::poll_warden ward;
+        ward.run(abandon, std::ref(ward));
+    });
+
+
+}
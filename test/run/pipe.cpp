@@ -1,7 +1,11 @@
 #include <felspar/io/pipe.hpp>
+#include <felspar/coro/eager.hpp>
 #include <felspar/test.hpp>
 
 #include <felspar/io/read.hpp>
+#ifdef FELSPAR_ENABLE_EPOLL
+#include <felspar/io/warden.epoll.hpp>
+#endif
 #include <felspar/io/warden.poll.hpp>
 #include <felspar/io/write.hpp>
 
@@ -79,4 +83,35 @@ namespace {
             });
 
 
+    felspar::io::warden::task<std::size_t> read_one(
+            felspar::io::warden &ward, felspar::posix::fd const &fd) {
+        std::array<std::byte, 1> buffer;
+        co_return co_await ward.read_some(fd, buffer, 20ms);
+    }
+    felspar::io::warden::task<void> readers(felspar::io::warden &ward) {
+        felspar::test::injected check;
+
+        auto pipe = ward.create_pipe();
+        felspar::io::warden::eager<std::size_t> first, second;
+        first.post(read_one, std::ref(ward), std::cref(pipe.read));
+        second.post(read_one, std::ref(ward), std::cref(pipe.read));
+
+        std::array<std::uint8_t, 2> out{1, 2};
+        co_await felspar::io::write_all(ward, pipe.write, out, 20ms);
+
+        check(co_await std::move(first).release()) == 1u;
+        check(co_await std::move(second).release()) == 1u;
+    }
+    auto const tr = suite.test("two readers/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(readers);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const te = suite.test("two readers/epoll", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(readers);
+    });
+#endif
+
+
 }
@@ -0,0 +1,156 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+#include <unistd.h>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("warden_pool");
+
+
+    constexpr std::size_t connections{24};
+
+
+    felspar::io::warden::task<void> echo_once(
+            felspar::io::warden &ward,
+            felspar::posix::fd fd,
+            std::atomic<std::size_t> &served) {
+        std::array<std::byte, 1> buffer;
+        if (co_await ward.read_some(fd, buffer, 1s)) {
+            ++served;
+            co_await ward.write_some(fd, buffer, 1s);
+        }
+    }
+    felspar::io::warden::task<void> serve(
+            felspar::io::warden &ward,
+            felspar::posix::fd const &listener,
+            std::atomic<std::size_t> &served) {
+        felspar::io::warden::starter<void> echoes;
+        for (auto accepting = felspar::io::accept(ward, listener);
+             auto cnx = co_await accepting.next();) {
+            echoes.post(
+                    echo_once, std::ref(ward), felspar::posix::fd{*cnx},
+                    std::ref(served));
+            echoes.garbage_collect_completed();
+        }
+    }
+
+
+    /// A plain blocking client, which stops the pool once it is done
+    template<typename W>
+    void client(felspar::io::warden_pool<W> &pool, std::uint16_t const port) {
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        for (std::size_t index{}; index < connections; ++index) {
+            felspar::posix::fd fd{::socket(AF_INET, SOCK_STREAM, 0)};
+            if (::connect(
+                        fd.native_handle(),
+                        reinterpret_cast<sockaddr const *>(&in), sizeof(in))
+                == 0) {
+                char b = 'x';
+                if (::write(fd.native_handle(), &b, 1) == 1) {
+                    [[maybe_unused]] auto const r =
+                            ::read(fd.native_handle(), &b, 1);
+                }
+            }
+        }
+        pool.stop();
+    }
+
+
+    template<typename W>
+    void sharded(auto check, std::uint16_t const port) {
+        felspar::io::warden_pool<W> pool{3};
+        check(pool.size()) == 3u;
+        pool.listen(port, 64);
+        std::atomic<std::size_t> served{};
+        std::thread connecting{[&]() { client(pool, port); }};
+        pool.run(serve, std::ref(served));
+        connecting.join();
+        check(served.load()) == connections;
+        check(pool.stop_requested()) == true;
+    }
+    auto const p = suite.test("poll", [](auto check) {
+        sharded<felspar::io::poll_warden>(check, 5590);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const e = suite.test("epoll", [](auto check) {
+        sharded<felspar::io::epoll_warden>(check, 5591);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const u = suite.test("io_uring", [](auto check) {
+        sharded<felspar::io::uring_warden>(check, 5592);
+    });
+#endif
+
+
+    /// An exception on one warden stops the others
+    felspar::io::warden::task<void> fail_one(
+            felspar::io::warden &ward,
+            felspar::posix::fd const &listener,
+            std::atomic<bool> &failed) {
+        if (not failed.exchange(true)) {
+            co_await ward.sleep(5ms);
+            throw felspar::stdexcept::runtime_error{"Failed"};
+        }
+        for (auto accepting = felspar::io::accept(ward, listener);
+             co_await accepting.next();) {}
+    }
+    auto const f = suite.test("failure", [](auto check) {
+        felspar::io::warden_pool<felspar::io::poll_warden> pool{2};
+        pool.listen(5593, 64);
+        std::atomic<bool> failed{};
+        check([&]() {
+            pool.run(fail_one, std::ref(failed));
+        }).template throws_type<felspar::stdexcept::runtime_error>();
+        check(pool.stop_requested()) == true;
+    });
+
+
+    /// The pool's accept streams end straight away if started after the stop
+    felspar::io::warden::task<void> stop_early(
+            felspar::io::warden &ward,
+            felspar::posix::fd const &listener,
+            felspar::io::warden_pool<felspar::io::poll_warden> &pool) {
+        pool.stop();
+        co_await ward.sleep(10ms);
+        for (auto accepting = pool.accept(ward, listener);
+             co_await accepting.next();) {}
+    }
+    auto const s = suite.test("stop_early", [](auto check) {
+        felspar::io::warden_pool<felspar::io::poll_warden> pool{2};
+        pool.listen(5594, 64);
+        pool.run(stop_early, std::ref(pool));
+        check(pool.stop_requested()) == true;
+    });
+
+
+    /// Each warden is made on the thread that runs it
+    struct recording_warden : public felspar::io::poll_warden {
+        std::thread::id const made = std::this_thread::get_id();
+    };
+    felspar::io::warden::task<void> made_here(
+            felspar::io::warden &ward, felspar::posix::fd const &) {
+        felspar::test::injected check;
+        check(static_cast<recording_warden &>(ward).made
+              == std::this_thread::get_id())
+                == true;
+        co_return;
+    }
+    auto const t = suite.test("threads", [](auto check) {
+        felspar::io::warden_pool<recording_warden> pool{3};
+        check(pool[0].made != std::this_thread::get_id()) == true;
+        pool.run(made_here);
+        pool.run(made_here);
+    });
+
+
+}
@@ -0,0 +1,93 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("pooled");
+
+
+    /**
+     * Data read into the pool is handed back as a lease, and the buffer only
+     * returns to the pool once the lease is released.
+     */
+    felspar::io::warden::task<void> lease(felspar::io::warden &ward) {
+        felspar::test::injected check;
+
+        auto pipe = ward.create_pipe();
+        std::array<std::uint8_t, 6> out{1, 2, 3, 4, 5, 6};
+        co_await felspar::io::write_all(ward, pipe.write, out, 20ms);
+
+        auto read = co_await ward.read_pooled(pipe.read, 20ms);
+        check(read.size()) == 6u;
+        check(read.data()[0]) == std::byte{1};
+        check(read.data()[5]) == std::byte{6};
+        check(ward.buffer_statistics().in_use) == 1u;
+
+        read.release();
+        check(read.empty()).is_truthy();
+        check(ward.buffer_statistics().in_use) == 0u;
+        check(ward.buffer_statistics().high_water) == 1u;
+    }
+    auto const lp = suite.test("lease/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(lease);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const le = suite.test("lease/epoll", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(lease);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const lu = suite.test("lease/uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(lease);
+    });
+#endif
+
+
+    /// With every buffer leased out the next read fails once data arrives
+    felspar::io::warden::task<void> exhausted(felspar::io::warden &ward) {
+        felspar::test::injected check;
+        ward.read_buffer_options = {.buffer_size = 16, .buffers = 1};
+
+        auto pipe = ward.create_pipe();
+        std::array<std::uint8_t, 3> out{1, 2, 3};
+        co_await felspar::io::write_all(ward, pipe.write, out, 20ms);
+        auto held = co_await ward.read_pooled(pipe.read, 20ms);
+        check(held.size()) == 3u;
+
+        co_await felspar::io::write_all(ward, pipe.write, out, 20ms);
+        auto failed =
+                co_await felspar::io::ec{ward.read_pooled(pipe.read, 20ms)};
+        check(failed.error) == std::error_code{ENOBUFS, std::system_category()};
+        check(ward.buffer_statistics().exhausted) == 1u;
+
+        held.release();
+        auto read = co_await ward.read_pooled(pipe.read, 20ms);
+        check(read.size()) == 3u;
+    }
+    auto const ep = suite.test("exhausted/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(exhausted);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const ee = suite.test("exhausted/epoll", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(exhausted);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const eu = suite.test("exhausted/uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(exhausted);
+    });
+#endif
+
+
+}
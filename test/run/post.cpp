@@ -0,0 +1,108 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+#include <thread>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("post");
+
+
+    /// Continue the coroutine on a new thread
+    struct on_new_thread {
+        std::thread &thread;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(felspar::coro::coroutine_handle<> h) {
+            thread = std::thread{[h]() { h.resume(); }};
+        }
+        void await_resume() const noexcept {}
+    };
+    felspar::io::warden::task<void>
+            hop(felspar::io::warden &ward, std::thread &thread) {
+        felspar::test::injected check;
+        auto const home = std::this_thread::get_id();
+        co_await on_new_thread{thread};
+        check(std::this_thread::get_id()) != home;
+        /// The warden's loop is waiting with nothing else to do
+        co_await felspar::io::resume_on{ward};
+        check(std::this_thread::get_id()) == home;
+    }
+    felspar::io::warden::task<void> hop_back(felspar::io::warden &ward) {
+        std::thread thread;
+        co_await hop(ward, thread);
+        thread.join();
+    }
+    auto const ph = suite.test("poll/resume_on", []() {
+        felspar::io::poll_warden ward;
+        ward.run(hop_back);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const eh = suite.test("epoll/resume_on", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(hop_back);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const uh = suite.test("io_uring/resume_on", []() {
+        felspar::io::uring_warden ward;
+        ward.run(hop_back);
+    });
+#endif
+
+
+    /// Every post runs, and those from each thread run in order
+    struct suspend_into {
+        felspar::coro::coroutine_handle<> &handle;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(felspar::coro::coroutine_handle<> h) { handle = h; }
+        void await_resume() const noexcept {}
+    };
+    felspar::io::warden::task<void> many(felspar::io::warden &ward) {
+        felspar::test::injected check;
+        constexpr std::size_t threads{4}, posts{1000};
+        std::size_t count{};
+        std::array<std::size_t, threads> next{};
+        bool in_order = true;
+        felspar::coro::coroutine_handle<> waiting;
+
+        std::vector<std::thread> posters;
+        for (std::size_t t{}; t < threads; ++t) {
+            posters.emplace_back([&, t]() {
+                for (std::size_t p{}; p < posts; ++p) {
+                    ward.post([&, t, p]() {
+                        in_order = in_order and next[t]++ == p;
+                        if (++count == threads * posts) { waiting.resume(); }
+                    });
+                }
+            });
+        }
+        /// Posted functions only run once this has suspended
+        co_await suspend_into{waiting};
+        for (auto &p : posters) { p.join(); }
+        check(count) == threads * posts;
+        check(in_order) == true;
+    }
+    auto const pm = suite.test("poll/many", []() {
+        felspar::io::poll_warden ward;
+        ward.run(many);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const em = suite.test("epoll/many", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(many);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const um = suite.test("io_uring/many", []() {
+        felspar::io::uring_warden ward;
+        ward.run(many);
+    });
+#endif
+
+
+}
@@ -0,0 +1,329 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("resolver");
+
+
+    sockaddr_in loopback(std::uint16_t const port) {
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return in;
+    }
+    in_addr ipv4(char const *const address) {
+        in_addr in{};
+        ::inet_pton(AF_INET, address, &in);
+        return in;
+    }
+
+
+    /**
+     * A stand-in name server on its own thread. `example.test` has two
+     * addresses, `missing.test` doesn't exist, the reply for `long.test` is
+     * truncated and the server fails for everything else.
+     */
+    class stand_in {
+        felspar::posix::fd sock{::socket(AF_INET, SOCK_DGRAM, 0)};
+        std::atomic<bool> stopping{false};
+        std::thread thread;
+
+        void serve() {
+            timeval poll_time{0, 10'000};
+            ::setsockopt(
+                    sock.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &poll_time,
+                    sizeof(poll_time));
+            while (not stopping) {
+                std::array<std::uint8_t, 512> in;
+                sockaddr_in from{};
+                socklen_t from_size = sizeof(from);
+                auto const bytes = ::recvfrom(
+                        sock.native_handle(), in.data(), in.size(), 0,
+                        reinterpret_cast<sockaddr *>(&from), &from_size);
+                if (bytes < 12) { continue; }
+                ++queries;
+                auto const out = reply({in.data(), std::size_t(bytes)});
+                ::sendto(
+                        sock.native_handle(), out.data(), out.size(), 0,
+                        reinterpret_cast<sockaddr const *>(&from), from_size);
+            }
+        }
+
+        static std::vector<std::uint8_t>
+                reply(std::span<std::uint8_t const> const query) {
+            std::string name;
+            std::size_t at = 12;
+            while (at < query.size() and query[at]) {
+                if (not name.empty()) { name += '.'; }
+                name.append(
+                        reinterpret_cast<char const *>(&query[at + 1]),
+                        query[at]);
+                at += query[at] + 1;
+            }
+            /// The header and question are sent back
+            std::vector<std::uint8_t> out{
+                    query.begin(), query.begin() + at + 5};
+            auto const put16 = [&](std::uint16_t const v) {
+                out.push_back(v >> 8);
+                out.push_back(v & 0xff);
+            };
+            auto const set16 = [&](std::size_t const offset,
+                                   std::uint16_t const v) {
+                out[offset] = v >> 8;
+                out[offset + 1] = v & 0xff;
+            };
+            if (name == "example.test") {
+                set16(2, 0x8180);
+                set16(6, 2);
+                for (std::uint8_t const last : {1, 2}) {
+                    put16(0xc00c);
+                    put16(1);
+                    put16(1);
+                    put16(0);
+                    put16(60);
+                    put16(4);
+                    out.insert(out.end(), {10, 0, 0, last});
+                }
+            } else if (name == "missing.test") {
+                set16(2, 0x8183);
+                set16(8, 1);
+                put16(0xc00c);
+                put16(6);
+                put16(1);
+                put16(0);
+                put16(60);
+                put16(22);
+                out.insert(out.end(), {0, 0});
+                for (std::size_t count{}; count < 4; ++count) {
+                    put16(0);
+                    put16(1);
+                }
+                put16(0);
+                put16(60);
+            } else if (name == "long.test") {
+                set16(2, 0x8380);
+            } else {
+                set16(2, 0x8182);
+            }
+            return out;
+        }
+
+
+      public:
+        std::atomic<std::size_t> queries{};
+
+        explicit stand_in(std::uint16_t const port) {
+            auto const address = loopback(port);
+            felspar::posix::set_reuse_port(sock);
+            ::bind(sock.native_handle(),
+                   reinterpret_cast<sockaddr const *>(&address),
+                   sizeof(address));
+            thread = std::thread{[this]() { serve(); }};
+        }
+        ~stand_in() {
+            stopping = true;
+            thread.join();
+        }
+    };
+
+
+    felspar::io::resolver::options
+            settings(std::uint16_t const port, std::string hosts = {}) {
+        return {.servers = {loopback(port)},
+                .resolv_conf = {},
+                .hosts = std::move(hosts),
+                .timeout = 200ms};
+    }
+
+
+    /// Answers come from the server the first time and the cache after that
+    felspar::io::warden::task<void> lookup(
+            felspar::io::warden &ward,
+            felspar::io::resolver &names,
+            stand_in &server) {
+        felspar::test::injected check;
+        auto const found = co_await names.resolve(ward, "Example.Test.");
+        check(found.size()) == 2u;
+        check(found[0].s_addr) == ipv4("10.0.0.1").s_addr;
+        check(found[1].s_addr) == ipv4("10.0.0.2").s_addr;
+        check(server.queries.load()) == 1u;
+
+        auto const again = co_await names.resolve(ward, "example.test");
+        check(again.size()) == 2u;
+        check(server.queries.load()) == 1u;
+        check(names.counters().cache_hits) == 1u;
+
+        auto const numeric = co_await names.resolve(ward, "192.0.2.7");
+        check(numeric.size()) == 1u;
+        check(numeric[0].s_addr) == ipv4("192.0.2.7").s_addr;
+        check(server.queries.load()) == 1u;
+    }
+    auto const pl = suite.test("poll/lookup", []() {
+        stand_in server{5600};
+        felspar::io::resolver names{settings(5600)};
+        felspar::io::poll_warden ward;
+        ward.run(lookup, std::ref(names), std::ref(server));
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const el = suite.test("epoll/lookup", []() {
+        stand_in server{5600};
+        felspar::io::resolver names{settings(5600)};
+        felspar::io::epoll_warden ward;
+        ward.run(lookup, std::ref(names), std::ref(server));
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const ul = suite.test("io_uring/lookup", []() {
+        stand_in server{5600};
+        felspar::io::resolver names{settings(5600)};
+        felspar::io::uring_warden ward;
+        ward.run(lookup, std::ref(names), std::ref(server));
+    });
+#endif
+
+
+    /// Names that don't exist are cached too
+    felspar::io::warden::task<std::size_t> missing(
+            felspar::io::warden &ward,
+            felspar::io::resolver &names,
+            std::size_t const times) {
+        std::size_t not_found{};
+        for (std::size_t index{}; index < times; ++index) {
+            try {
+                co_await names.resolve(ward, "missing.test");
+            } catch (felspar::io::host_not_found const &) { ++not_found; }
+        }
+        co_return not_found;
+    }
+    auto const pn = suite.test("poll/negative", [](auto check) {
+        stand_in server{5601};
+        felspar::io::resolver names{settings(5601)};
+        felspar::io::poll_warden ward;
+        check(ward.run(missing, std::ref(names), 3u)) == 3u;
+        check(server.queries.load()) == 1u;
+        check(names.cached()) == 1u;
+    });
+
+
+    /// Nothing is kept for longer than the maximum
+    felspar::io::warden::task<void> expire(
+            felspar::io::warden &ward,
+            felspar::io::resolver &names,
+            stand_in &server) {
+        felspar::test::injected check;
+        co_await names.resolve(ward, "example.test");
+        co_await names.resolve(ward, "example.test");
+        check(server.queries.load()) == 1u;
+        co_await ward.sleep(30ms);
+        co_await names.resolve(ward, "example.test");
+        check(server.queries.load()) == 2u;
+    }
+    auto const pe = suite.test("poll/expire", [](auto check) {
+        stand_in server{5602};
+        auto o = settings(5602);
+        o.max_ttl = 20ms;
+        felspar::io::resolver names{o};
+        felspar::io::poll_warden ward;
+        ward.run(expire, std::ref(names), std::ref(server));
+        /// Looking up another name drops the expired entry
+        std::this_thread::sleep_for(30ms);
+        check(names.cached()) == 1u;
+        check(ward.run(missing, std::ref(names), 1u)) == 1u;
+        check(names.cached()) == 1u;
+    });
+
+
+    /// Server failures aren't cached and are reported once all tries fail
+    felspar::io::warden::task<void>
+            failure(felspar::io::warden &ward, felspar::io::resolver &names) {
+        co_await names.resolve(ward, "other.test");
+    }
+    auto const pf = suite.test("poll/failure", [](auto check) {
+        stand_in server{5603};
+        felspar::io::resolver names{settings(5603)};
+        felspar::io::poll_warden ward;
+        check([&]() {
+            ward.run(failure, std::ref(names));
+        }).template throws_type<felspar::stdexcept::runtime_error>();
+        check(server.queries.load()) == 2u;
+        check(names.cached()) == 0u;
+    });
+
+
+    /// Truncated replies are failures too
+    felspar::io::warden::task<void>
+            truncated(felspar::io::warden &ward, felspar::io::resolver &names) {
+        co_await names.resolve(ward, "long.test");
+    }
+    auto const pt = suite.test("poll/truncated", [](auto check) {
+        stand_in server{5606};
+        felspar::io::resolver names{settings(5606)};
+        felspar::io::poll_warden ward;
+        check([&]() {
+            ward.run(truncated, std::ref(names));
+        }).template throws_type<felspar::stdexcept::runtime_error>();
+        check(server.queries.load()) == 2u;
+        check(names.cached()) == 0u;
+    });
+
+
+    /// Names from the hosts file are used for `connect`
+    felspar::io::warden::task<void>
+            by_name(felspar::io::warden &ward, felspar::io::resolver &names) {
+        felspar::test::injected check;
+        auto listener = ward.create_tcp_socket();
+        felspar::posix::set_reuse_port(listener);
+        felspar::posix::bind_to_any_address(listener, 5604);
+        felspar::posix::listen(listener, 1);
+
+        auto client = co_await felspar::io::connect(
+                ward, names, "Local.Test", 5604, 1s);
+        felspar::posix::fd server{co_await ward.accept(listener, 1s)};
+        check(client.native_handle()) >= 0;
+        check(server.native_handle()) >= 0;
+        check(names.counters().queries) == 0u;
+    }
+    auto const pc = suite.test("poll/connect", []() {
+        auto const path = std::filesystem::temp_directory_path()
+                / ("felspar-io-hosts-" + std::to_string(::getpid()));
+        std::ofstream{path} << "# Test hosts\n"
+                               "::1 ip6-localhost\n"
+                               "127.0.0.1 local.test other-name\n";
+        felspar::io::resolver names{settings(5605, path.string())};
+        felspar::io::poll_warden ward;
+        ward.run(by_name, std::ref(names));
+        std::filesystem::remove(path);
+    });
+
+
+    /// Options that can't be used are ignored or raised to one
+    auto const rc = suite.test("resolv_conf", [](auto check) {
+        auto const path = std::filesystem::temp_directory_path()
+                / ("felspar-io-resolv-" + std::to_string(::getpid()));
+        std::ofstream{path} << "nameserver 127.0.0.1\n"
+                               "options timeout:0 attempts:many\n"
+                               "options attempts:0 timeout:3s\n";
+        felspar::io::resolver names{
+                {.resolv_conf = path.string(), .hosts = {}}};
+        std::filesystem::remove(path);
+        check(names.settings.servers.size()) == 1u;
+        check(names.settings.timeout == 1s) == true;
+        check(names.settings.attempts) == 1u;
+    });
+
+
+}
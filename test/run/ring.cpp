@@ -0,0 +1,93 @@
+#include <felspar/io.hpp>
+#include <felspar/coro/eager.hpp>
+#include <felspar/test.hpp>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("ring");
+
+
+#ifdef FELSPAR_ENABLE_IO_URING
+    felspar::io::warden::task<void>
+            reader(felspar::io::warden &ward, felspar::posix::fd const &fd) {
+        felspar::test::injected check;
+        std::array<std::byte, 1> buffer;
+        check(co_await ward.read_some(fd, buffer, 200ms)) == 1u;
+    }
+
+
+    /**
+     * Every read has a time out, so needs two SQEs. Many more are started
+     * than the submission queue can hold.
+     */
+    felspar::io::warden::task<void> burst(felspar::io::warden &ward) {
+        std::vector<felspar::io::pipe> pipes;
+        for (std::size_t index{}; index < 32; ++index) {
+            pipes.push_back(ward.create_pipe());
+        }
+        std::vector<felspar::io::warden::eager<>> readers(pipes.size());
+        for (std::size_t index{}; index < pipes.size(); ++index) {
+            readers[index].post(
+                    reader, std::ref(ward), std::cref(pipes[index].read));
+        }
+        std::array<std::byte, 1> const data{std::byte{1}};
+        for (auto const &p : pipes) {
+            co_await ward.write_some(p.write, data, 20ms);
+        }
+        for (auto &r : readers) { co_await std::move(r).release(); }
+    }
+
+
+    auto const full = suite.test("sq_full", [](auto check) {
+        felspar::io::uring_warden ward{4};
+        ward.run(burst);
+        check(ward.ring_statistics().sq_full_submits) > 0u;
+        check(ward.ring_statistics().in_flight) == 0u;
+        check(ward.ring_statistics().peak_in_flight) > 4u;
+        check(ward.ring_statistics().resizes) == 0u;
+    });
+
+
+    auto const grow = suite.test("grow", [](auto check) {
+        felspar::io::uring_warden ward{4};
+        ward.grow_ring = true;
+        ward.run(burst);
+        check(ward.ring_statistics().resizes) == 0u;
+        auto const full_submits = ward.ring_statistics().sq_full_submits;
+        ward.run(burst);
+        check(ward.ring_statistics().resizes) == 1u;
+        check(ward.ring_statistics().sq_full_submits) == full_submits;
+    });
+
+
+    auto const tuned = suite.test("tuned", [](auto check) {
+        felspar::io::uring_warden ward{{
+                .entries = 4,
+                .single_issuer = true,
+                .defer_taskrun = true,
+                .coop_taskrun = true,
+                .register_ring_fd = true,
+        }};
+        ward.run(burst);
+        check(ward.ring_statistics().in_flight) == 0u;
+        check(ward.ring_statistics().kernel_enters) > 0u;
+    });
+
+
+    auto const polled = suite.test("sqpoll", [](auto check) {
+        felspar::io::uring_warden ward{{
+                .entries = 4,
+                .polling = felspar::io::uring_warden::sq_poll{.idle = 10ms},
+        }};
+        ward.run(burst);
+        check(ward.ring_statistics().in_flight) == 0u;
+    });
+#endif
+
+
+}
@@ -61,6 +61,22 @@ namespace {
         /// Should not hang
         std::move(accept).release().get();
     });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const ae = suite.test("accept/epoll", [](auto check) {
+        felspar::io::epoll_warden ward;
+
+        felspar::io::warden::eager<> accept;
+        accept.post(accept_forever, std::ref(ward), 5548);
+        check(time_loop(ward)) < 15ms;
+
+        felspar::io::warden::eager<> connect;
+        connect.post(do_connect, std::ref(ward), 5548);
+        check(time_loop(ward)) < 15ms;
+
+        /// Should not hang
+        std::move(accept).release().get();
+    });
+#endif
 #ifdef FELSPAR_ENABLE_IO_URING
     auto const au = suite.test("accept/io_uring", [](auto check) {
         felspar::io::uring_warden ward;
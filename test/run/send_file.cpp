@@ -0,0 +1,102 @@
+#include <felspar/io.hpp>
+#include <felspar/coro/eager.hpp>
+#include <felspar/test.hpp>
+
+#include <cstdlib>
+#include <unistd.h>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("send_file");
+
+
+    constexpr std::size_t file_size{300 << 10}, offset{1000};
+
+
+    felspar::posix::fd temporary_file() {
+        char name[] = "/tmp/felspar-io-send-file-XXXXXX";
+        felspar::posix::fd file{::mkstemp(name)};
+        ::unlink(name);
+        std::vector<std::uint8_t> data(file_size);
+        for (std::size_t index{}; index < data.size(); ++index) {
+            data[index] = static_cast<std::uint8_t>(index % 251);
+        }
+        for (std::span<std::uint8_t const> out{data}; out.size();) {
+            auto const bytes =
+                    ::write(file.native_handle(), out.data(), out.size());
+            if (bytes <= 0) { break; }
+            out = out.subspan(bytes);
+        }
+        return file;
+    }
+
+
+    felspar::io::warden::task<std::size_t>
+            receive(felspar::io::warden &ward, felspar::posix::fd const &fd) {
+        std::array<std::uint8_t, 16 << 10> buffer;
+        std::size_t received{};
+        while (auto const bytes = co_await ward.read_some(
+                       fd, std::as_writable_bytes(std::span{buffer}), 100ms)) {
+            for (auto const b : std::span{buffer}.first(bytes)) {
+                if (b != (offset + received++) % 251) { co_return 0; }
+            }
+        }
+        co_return received;
+    }
+
+
+    /// Everything after the offset arrives, in order
+    felspar::io::warden::task<void>
+            send(felspar::io::warden &ward, std::uint16_t const port) {
+        felspar::test::injected check;
+        auto file = temporary_file();
+
+        auto listener = ward.create_tcp_socket();
+        felspar::posix::set_reuse_port(listener);
+        felspar::posix::bind_to_any_address(listener, port);
+        felspar::posix::listen(listener, 1);
+
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        auto client = ward.create_tcp_socket();
+        co_await ward.connect(
+                client, reinterpret_cast<sockaddr const *>(&in), sizeof(in),
+                20ms);
+        felspar::posix::fd server{co_await ward.accept(listener, 20ms)};
+
+        felspar::io::warden::eager<std::size_t> receiving;
+        receiving.post(receive, std::ref(ward), std::cref(client));
+        check(co_await felspar::io::send_file(
+                ward, server, file, offset, file_size, 100ms))
+                == file_size - offset;
+        server.close();
+        check(co_await std::move(receiving).release()) == file_size - offset;
+    }
+
+
+    auto const poll = suite.test("poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(send, 5580);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const epoll = suite.test("epoll", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(send, 5581);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const uring = suite.test("uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(send, 5582);
+    });
+#endif
+
+
+}
@@ -0,0 +1,86 @@
+#include <felspar/io.hpp>
+#include <felspar/coro/eager.hpp>
+#include <felspar/test.hpp>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("send_zc");
+
+
+    constexpr std::size_t total{256 << 10};
+
+
+    felspar::io::warden::task<std::size_t>
+            receive(felspar::io::warden &ward, felspar::posix::fd const &fd) {
+        std::array<std::byte, 16 << 10> buffer;
+        std::size_t received{};
+        while (received < total) {
+            auto const bytes = co_await ward.read_some(fd, buffer, 100ms);
+            if (not bytes) { break; }
+            for (auto const b : std::span{buffer}.first(bytes)) {
+                if (b != std::byte(received++)) { co_return received; }
+            }
+        }
+        co_return received;
+    }
+
+
+    /// A large buffer is sent in pieces, each released before the next
+    felspar::io::warden::task<void>
+            send(felspar::io::warden &ward, std::uint16_t const port) {
+        felspar::test::injected check;
+
+        auto listener = ward.create_tcp_socket();
+        felspar::posix::set_reuse_port(listener);
+        felspar::posix::bind_to_any_address(listener, port);
+        felspar::posix::listen(listener, 1);
+
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_port = htons(port);
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        auto client = ward.create_tcp_socket();
+        co_await ward.connect(
+                client, reinterpret_cast<sockaddr const *>(&in), sizeof(in),
+                20ms);
+        felspar::posix::fd server{co_await ward.accept(listener, 20ms)};
+
+        std::vector<std::byte> data(total);
+        for (std::size_t index{}; index < data.size(); ++index) {
+            data[index] = std::byte(index);
+        }
+        felspar::io::warden::eager<std::size_t> receiving;
+        receiving.post(receive, std::ref(ward), std::cref(client));
+        for (std::span<std::byte const> out{data}; out.size();) {
+            auto const sent = co_await ward.send_zc(server, out, 100ms);
+            check(sent) > 0u;
+            out = out.subspan(sent);
+        }
+        check(co_await std::move(receiving).release()) == total;
+    }
+
+
+    auto const poll = suite.test("poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(send, 5570);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const epoll = suite.test("epoll", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(send, 5571);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const uring = suite.test("uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(send, 5572);
+    });
+#endif
+
+
+}
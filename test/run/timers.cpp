@@ -1,5 +1,6 @@
 #include <felspar/io.hpp>
 #include <felspar/coro/eager.hpp>
+#include <felspar/coro/starter.hpp>
 #include <felspar/test.hpp>
 
 
@@ -24,6 +25,12 @@ namespace {
         felspar::io::poll_warden ward;
         check(ward.run(short_sleep)) == true;
     });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const sse = suite.test("timers/epoll", [](auto check) {
+        felspar::io::epoll_warden ward;
+        check(ward.run(short_sleep)) == true;
+    });
+#endif
 #ifdef FELSPAR_ENABLE_IO_URING
     auto const ssu = suite.test("timers/uring", [](auto check) {
         felspar::io::uring_warden ward{5};
@@ -32,6 +39,106 @@ namespace {
 #endif
 
 
+    felspar::io::warden::task<void> timed_sleep(
+            felspar::io::warden &ward,
+            std::chrono::milliseconds const duration,
+            std::size_t &woken) {
+        felspar::test::injected check;
+        auto const start = std::chrono::steady_clock::now();
+        co_await ward.sleep(duration);
+        auto const slept = std::chrono::steady_clock::now() - start;
+        check(slept >= duration - 1ms) == true;
+        ++woken;
+    }
+    felspar::io::warden::task<std::size_t>
+            many_sleeps(felspar::io::warden &ward) {
+        std::size_t woken{};
+        {
+            /**
+             * These are all cancelled before they can complete. The
+             * `uring_warden` doesn't cancel sleeps in the kernel, so they
+             * must outlast the run.
+             */
+            felspar::io::warden::starter<void> cancelled;
+            for (auto const duration : {230ms, 300ms, 5000ms}) {
+                cancelled.post(
+                        timed_sleep, std::ref(ward), duration,
+                        std::ref(woken));
+            }
+        }
+        /// Spread across enough time that timers have to cascade
+        felspar::io::warden::starter<void> sleepers;
+        for (std::size_t index{}; index < 100; ++index) {
+            sleepers.post(
+                    timed_sleep, std::ref(ward),
+                    std::chrono::milliseconds{1 + (index * 37) % 150},
+                    std::ref(woken));
+        }
+        co_await ward.sleep(200ms);
+        co_return woken;
+    }
+    auto const msp = suite.test("many/poll", [](auto check) {
+        felspar::io::poll_warden ward;
+        check(ward.run(many_sleeps)) == 100u;
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const mse = suite.test("many/epoll", [](auto check) {
+        felspar::io::epoll_warden ward;
+        check(ward.run(many_sleeps)) == 100u;
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const msu = suite.test("many/uring", [](auto check) {
+        felspar::io::uring_warden ward;
+        check(ward.run(many_sleeps)) == 100u;
+    });
+#endif
+
+
+    felspar::io::warden::task<void> slack_sleep(
+            felspar::io::warden &ward,
+            std::chrono::nanoseconds const duration,
+            std::chrono::nanoseconds const slack) {
+        felspar::test::injected check;
+        auto const start = std::chrono::steady_clock::now();
+        co_await ward.sleep(duration, slack);
+        auto const slept = std::chrono::steady_clock::now() - start;
+        check(slept >= duration - 1ms) == true;
+    }
+    /// Returns the number of times the loop waited for the sleeps
+    felspar::io::warden::task<std::size_t> staggered_sleeps(
+            felspar::io::warden &ward, std::chrono::nanoseconds const slack) {
+        auto const before = ward.statistics().waits;
+        felspar::io::warden::starter<void> sleepers;
+        for (std::size_t index{}; index < 40; ++index) {
+            sleepers.post(
+                    slack_sleep, std::ref(ward), 5ms + index * 250us, slack);
+        }
+        co_await ward.sleep(40ms);
+        co_return ward.statistics().waits - before;
+    }
+    template<typename Warden>
+    void check_coalescing(auto check) {
+        Warden separate, coalesced;
+        auto const each = separate.run(staggered_sleeps, 0ms);
+        auto const grouped = coalesced.run(staggered_sleeps, 8ms);
+        check(grouped * 3 < each) == true;
+    }
+    auto const csp = suite.test("coalesce/poll", [](auto check) {
+        check_coalescing<felspar::io::poll_warden>(check);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const cse = suite.test("coalesce/epoll", [](auto check) {
+        check_coalescing<felspar::io::epoll_warden>(check);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const csu = suite.test("coalesce/uring", [](auto check) {
+        check_coalescing<felspar::io::uring_warden>(check);
+    });
+#endif
+
+
     felspar::io::warden::task<void>
             accept_writer(felspar::io::warden &ward, std::uint16_t port) {
         auto fd = ward.create_socket(AF_INET, SOCK_STREAM, 0);
@@ -85,6 +192,14 @@ namespace {
         co.post(accept_writer, ward, 5534);
         ward.run(write_forever, 5534);
     });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const we = suite.test("write/epoll", []() {
+        felspar::io::epoll_warden ward;
+        felspar::io::warden::eager<> co;
+        co.post(accept_writer, ward, 5550);
+        ward.run(write_forever, 5550);
+    });
+#endif
 #ifdef FELSPAR_ENABLE_IO_URING
     auto const wu = suite.test("write/io_uring", []() {
         felspar::io::uring_warden ward;
@@ -119,6 +234,12 @@ namespace {
         felspar::io::poll_warden ward;
         ward.run(short_accept, 5538, check, std::ref(log));
     });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const ae = suite.test("accept/epoll", [](auto check, auto &log) {
+        felspar::io::epoll_warden ward;
+        ward.run(short_accept, 5551, check, std::ref(log));
+    });
+#endif
 #ifdef FELSPAR_ENABLE_IO_URING
     auto const au = suite.test("accept/io_uring", [](auto check, auto &log) {
         felspar::io::uring_warden ward;
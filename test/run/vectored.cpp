@@ -0,0 +1,94 @@
+#include <felspar/io.hpp>
+#include <felspar/test.hpp>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vectored");
+
+
+    /// A header and body go out together and are read back into two buffers
+    felspar::io::warden::task<void> header_body(felspar::io::warden &ward) {
+        felspar::test::injected check;
+        auto pipe = ward.create_pipe();
+
+        std::string_view const header{"HTTP/1.1 200 OK\r\n\r\n"}, body{"OK"};
+        std::array<std::span<std::byte const>, 3> const out{
+                std::as_bytes(std::span{header}),
+                std::span<std::byte const>{},
+                std::as_bytes(std::span{body})};
+        check(co_await felspar::io::write_all(ward, pipe.write, out, 20ms))
+                == header.size() + body.size();
+
+        std::array<std::byte, 4> first{};
+        std::array<std::byte, 32> second{};
+        auto const rest = header.size() + body.size() - first.size();
+        std::array<std::span<std::byte>, 2> const in{
+                first, std::span{second}.first(rest)};
+        check(co_await felspar::io::read_exactly(ward, pipe.read, in, 20ms))
+                == header.size() + body.size();
+        check(first[0]) == std::byte{'H'};
+        check(second[header.size() - 4]) == std::byte{'O'};
+        check(second[header.size() - 3]) == std::byte{'K'};
+    }
+    auto const hp = suite.test("header_body/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(header_body);
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const he = suite.test("header_body/epoll", []() {
+        felspar::io::epoll_warden ward;
+        ward.run(header_body);
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const hu = suite.test("header_body/uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(header_body);
+    });
+#endif
+
+
+    /// More buffers than the kernel takes at once are split over several IOPs
+    felspar::io::warden::task<void> many(felspar::io::warden &ward) {
+        felspar::test::injected check;
+        auto pipe = ward.create_pipe();
+        auto const count = 2 * felspar::io::warden::max_buffers + 1;
+
+        std::vector<std::byte> bytes(count);
+        for (std::size_t index{}; index < count; ++index) {
+            bytes[index] = std::byte(index);
+        }
+        std::vector<std::span<std::byte const>> out;
+        for (auto const &b : bytes) { out.emplace_back(&b, 1); }
+        check(co_await felspar::io::write_all(
+                ward, pipe.write,
+                std::span<std::span<std::byte const> const>{out}, 20ms))
+                == count;
+
+        std::vector<std::byte> back(count);
+        std::vector<std::span<std::byte>> in;
+        for (auto &b : back) { in.emplace_back(&b, 1); }
+        check(co_await felspar::io::read_exactly(
+                ward, pipe.read, std::span<std::span<std::byte> const>{in},
+                20ms))
+                == count;
+        check(back == bytes) == true;
+    }
+    auto const mp = suite.test("many/poll", []() {
+        felspar::io::poll_warden ward;
+        ward.run(many);
+    });
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const mu = suite.test("many/uring", []() {
+        felspar::io::uring_warden ward;
+        ward.run(many);
+    });
+#endif
+
+
+}
@@ -0,0 +1,108 @@
+#include <felspar/io.hpp>
+#include <felspar/coro/starter.hpp>
+#include <felspar/test.hpp>
+
+#include <thread>
+
+
+using namespace std::literals;
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("work_pool");
+
+
+    /// The function runs on a worker and the result arrives back home
+    felspar::io::warden::task<void>
+            hop(felspar::io::warden &ward, felspar::io::work_pool &pool) {
+        felspar::test::injected check;
+        auto const home = std::this_thread::get_id();
+        auto const worker = co_await felspar::io::run_on_pool(
+                ward, pool, []() { return std::this_thread::get_id(); });
+        check(worker) != home;
+        check(std::this_thread::get_id()) == home;
+
+        co_await pool.schedule();
+        check(std::this_thread::get_id()) != home;
+        co_await felspar::io::resume_on{ward};
+        check(std::this_thread::get_id()) == home;
+    }
+    auto const ph = suite.test("poll/hop", []() {
+        felspar::io::work_pool pool{2};
+        felspar::io::poll_warden ward;
+        ward.run(hop, std::ref(pool));
+    });
+#ifdef FELSPAR_ENABLE_EPOLL
+    auto const eh = suite.test("epoll/hop", []() {
+        felspar::io::work_pool pool{2};
+        felspar::io::epoll_warden ward;
+        ward.run(hop, std::ref(pool));
+    });
+#endif
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const uh = suite.test("io_uring/hop", []() {
+        felspar::io::work_pool pool{2};
+        felspar::io::uring_warden ward;
+        ward.run(hop, std::ref(pool));
+    });
+#endif
+
+
+    /// Exceptions are re-thrown on the warden's thread
+    felspar::io::warden::task<void>
+            failing(felspar::io::warden &ward, felspar::io::work_pool &pool) {
+        co_await felspar::io::run_on_pool(ward, pool, []() {
+            throw felspar::stdexcept::runtime_error{"Failed on the pool"};
+        });
+    }
+    auto const pf = suite.test("poll/throws", [](auto check) {
+        felspar::io::work_pool pool{2};
+        felspar::io::poll_warden ward;
+        check([&]() {
+            ward.run(failing, std::ref(pool));
+        }).template throws_type<felspar::stdexcept::runtime_error>();
+    });
+
+
+    /// Many coroutines share the workers and all come back
+    felspar::io::warden::task<void> add(
+            felspar::io::warden &ward,
+            felspar::io::work_pool &pool,
+            std::size_t const n,
+            std::size_t &total) {
+        total += co_await felspar::io::run_on_pool(ward, pool, [n]() {
+            std::size_t sum{};
+            for (std::size_t i{}; i <= n; ++i) { sum += i; }
+            return sum;
+        });
+    }
+    felspar::io::warden::task<std::size_t>
+            many(felspar::io::warden &ward, felspar::io::work_pool &pool) {
+        std::size_t total{};
+        felspar::io::warden::starter<void> adding;
+        for (std::size_t n{}; n < 500; ++n) {
+            adding.post(
+                    add, std::ref(ward), std::ref(pool), n,
+                    std::ref(total));
+        }
+        co_await adding.wait_for_all();
+        co_return total;
+    }
+    auto const pm = suite.test("poll/many", [](auto check) {
+        felspar::io::work_pool pool{4};
+        felspar::io::poll_warden ward;
+        /// The sum of n(n + 1)/2 for n up to 499
+        check(ward.run(many, std::ref(pool))) == 20833250u;
+    });
+#ifdef FELSPAR_ENABLE_IO_URING
+    auto const um = suite.test("io_uring/many", [](auto check) {
+        felspar::io::work_pool pool{4};
+        felspar::io::uring_warden ward;
+        check(ward.run(many, std::ref(pool))) == 20833250u;
+    });
+#endif
+
+
+}